@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+
+import numpy as np
+import pandas as pd
+import argparse
+
+# <output file>.phasespace written with /htpc/phasespace/volume, see
+# include/HTPCPhaseSpaceWriter.hh for the layout. The values are in the byte
+# order of the writing machine, read them on a machine of the same byte order.
+MAGIC = b'HTPCPS02'
+EXPOSURE_TAG = b'HTPCPSEX'
+RECORD = np.dtype([('eventid', '=i4'), ('pdg', '=i4'),
+                   ('x', '=f4'), ('y', '=f4'), ('z', '=f4'),
+                   ('cx', '=f4'), ('cy', '=f4'), ('cz', '=f4'),
+                   ('e', '=f4'), ('t', '=f4'), ('w', '=f4')])
+EXPOSURE = np.dtype([('tag', 'S8'), ('nevents', '=i8'), ('weight', '=f8')])
+
+
+def read_phasespace(
+        filename : str
+        )   -> pd.DataFrame:
+
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if data[:8] != MAGIC:
+        raise ValueError(f'{filename} is not a phase space file')
+
+    # exposure of the first stage in the trailer, stored in df.attrs
+    nbytes = len(data) - 8 - EXPOSURE.itemsize
+    if nbytes < 0 or nbytes % RECORD.itemsize:
+        raise ValueError(f'{filename} has no exposure, the first stage did not finish')
+    exposure = np.frombuffer(data, dtype=EXPOSURE, count=1, offset=len(data) - EXPOSURE.itemsize)[0]
+    if exposure['tag'] != EXPOSURE_TAG:
+        raise ValueError(f'{filename} has no exposure, the first stage did not finish')
+
+    df = pd.DataFrame(np.frombuffer(data, dtype=RECORD, count=nbytes // RECORD.itemsize, offset=8))
+    df.attrs['nevents'] = int(exposure['nevents'])
+    df.attrs['weight'] = float(exposure['weight'])
+    return df
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Summary of a phase space file')
+    parser.add_argument('filename')
+    args = parser.parse_args()
+
+    df = read_phasespace(args.filename)
+    print(f'{len(df)} particles from {df.eventid.nunique()} events, total weight {df.w.sum():g}')
+    print(f'exposure: {df.attrs["nevents"]} first stage events, total weight {df.attrs["weight"]:g}')
+    print(df.groupby('pdg').e.describe())
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+
+import numpy as np
+import pandas as pd
+import argparse
+
+# <output file>.primaries written with /htpc/output/primaryTable true, see
+# include/HTPCPrimaryTable.hh for the layout. The floats are in the byte order
+# of the writing machine, read them on a machine of the same byte order.
+MAGIC = b'HTPCPV01'
+COLUMNS = ['x', 'y', 'z', 'cx', 'cy', 'cz', 'e', 'w']
+
+
+def read_primaries(
+        filename : str
+        )   -> pd.DataFrame:
+
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if data[:8] != MAGIC:
+        raise ValueError(f'{filename} is not a primary table')
+
+    eventids = []
+    values = []
+    eventid = -1
+    pos = 8
+    while pos < len(data):
+        delta = 0
+        shift = 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            delta |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        eventid += delta
+        eventids.append(eventid)
+        values.append(data[pos:pos + 32])
+        pos += 32
+
+    table = np.frombuffer(b''.join(values), dtype='=f4').reshape(-1, 8)
+    df = pd.DataFrame(table, columns=COLUMNS)
+    df.insert(0, 'eventid', np.array(eventids, dtype=np.int64))
+    return df
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Summary of a primary vertex table')
+    parser.add_argument('filename')
+    args = parser.parse_args()
+
+    df = read_primaries(args.filename)
+    print(f'{len(df)} primaries, total weight {df.w.sum():g}')
+    print(df.describe())
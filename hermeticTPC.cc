@@ -1,6 +1,9 @@
 #include <string>
 #include <sstream>
+#include <iostream>
 #include <unistd.h>
+#include <getopt.h>
+#include <cstdlib>
 
 #include <G4GDMLParser.hh>
 #include <G4RunManager.hh>
@@ -21,9 +24,10 @@
 #include "HTPCSteppingAction.hh"
 #include "HTPCRunAction.hh"
 #include "HTPCEventAction.hh"
+#include "HTPCGeometryValidator.hh"
 #include "fileMerger.hh"
 
-void usage();
+void usage(int iExitCode = 1);
 
 int
 main(int argc, char **argv)
@@ -37,14 +41,25 @@ main(int argc, char **argv)
   bool bVisualize = false;
   bool bPreInitFromFile = false;
   bool bExportGDML = false;
+  bool bCheckGeometry = false;
+  int iCheckResolution = 10000;
+  int iCheckThreads = 0;
 
   bool bMacroFile = false;
   std::string hMacroFilename, hDataFilename, hPreInitFilename;
   std::string hCommand;
   int iNbEventsToSimulate = 0;
 
+  // long-only options
+  static struct option hLongOptions[] = {
+    {"check-geometry", optional_argument, 0, 'C'},
+    {"check-threads", required_argument, 0, 'T'},
+    {"help", no_argument, 0, 'h'},
+    {0, 0, 0, 0}
+  };
+
   // parse switches
-  while((c = getopt(argc,argv,"f:o:p:n:ivg")) != -1)
+  while((c = getopt_long(argc,argv,"f:o:p:n:ivgh",hLongOptions,0)) != -1)
   {
     switch(c)	{
 
@@ -80,6 +95,19 @@ main(int argc, char **argv)
         bExportGDML = true;
         break;
 
+      case 'C':
+        bCheckGeometry = true;
+        if(optarg) iCheckResolution = atoi(optarg);
+        break;
+
+      case 'T':
+        iCheckThreads = atoi(optarg);
+        break;
+
+      case 'h':
+        usage(0);
+        break;
+
       default:
         usage();
     }
@@ -121,7 +149,7 @@ main(int argc, char **argv)
   pRunManager->SetUserAction(pPrimaryGeneratorAction);
   pRunManager->SetUserAction(new HTPCStackingAction(pAnalysisManager));
   pRunManager->SetUserAction(new HTPCSteppingAction(pAnalysisManager));
-  pRunManager->SetUserAction(new HTPCRunAction(pAnalysisManager));
+  pRunManager->SetUserAction(new HTPCRunAction(pAnalysisManager, physList));
   pRunManager->SetUserAction(new HTPCEventAction(pAnalysisManager));
 
   // geometry IO
@@ -136,6 +164,20 @@ main(int argc, char **argv)
   // initialize it all....
   pRunManager->Initialize();
 
+  // geometry validation only, no events
+  if(bCheckGeometry)
+  {
+    HTPCGeometryValidator hValidator(iCheckResolution, iCheckThreads);
+    int iNbOverlaps = hValidator.CheckOverlaps(
+      G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume());
+    hValidator.PrintVolumeReport();
+
+    delete pAnalysisManager;
+    delete pRunManager;
+
+    return iNbOverlaps ? 1 : 0;
+  }
+
   G4ThreeVector gp(0, 0, 0);
   auto nav = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
   G4VPhysicalVolume* found = nav->LocateGlobalPointAndSetup(gp);
@@ -216,7 +258,21 @@ if (bVisualize){
 }
 
 void
-usage()
+usage(int iExitCode)
 {
-  exit(0);
+  std::ostream &hOut = iExitCode ? std::cerr : std::cout;
+  hOut << "usage: hermeticTPC [options]\n"
+       << "  -f <macro>                run the macro after initialisation\n"
+       << "  -o <file>                 output file (default events.root)\n"
+       << "  -p <macro>                run the macro before initialisation\n"
+       << "  -n <events>               number of events to simulate\n"
+       << "  -i                        interactive session with visualisation\n"
+       << "  -v                        write the geometry to a VRML file\n"
+       << "  -g                        export the geometry to geometry_export.gdml\n"
+       << "  --check-geometry[=points] check the placements for overlaps (default\n"
+       << "                            10000 surface points per solid) and print the\n"
+       << "                            volume and mass report, no events simulated\n"
+       << "  --check-threads=<n>       threads of the overlap check (default all cores)\n"
+       << "  -h, --help                print this help" << std::endl;
+  exit(iExitCode);
 }
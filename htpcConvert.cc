@@ -0,0 +1,162 @@
+// Converts the text inputs of the generators into the binary formats read
+// through HTPCBinaryInput:
+//
+//   htpcConvert multivertex <input.txt> <output.bin>
+//   htpcConvert muon <input.txt> <output.bin>
+//
+// The converted file is given to the generator in place of the text file,
+// the format is recognised from its magic.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HTPCBinaryInput.hh"
+
+void usage();
+
+// "EvID nsites" followed by 7 numbers per site
+int
+ConvertMultiVertex(const std::string &hInputFilename, const std::string &hOutputFilename)
+{
+  std::ifstream hInput(hInputFilename.c_str());
+  if(!hInput)
+    {
+      std::cerr << "htpcConvert: cannot open " << hInputFilename << std::endl;
+      return 1;
+    }
+
+  std::ofstream hOutput(hOutputFilename.c_str(), std::ios::binary | std::ios::trunc);
+  if(!hOutput)
+    {
+      std::cerr << "htpcConvert: cannot open " << hOutputFilename << std::endl;
+      return 1;
+    }
+  hOutput.write("HTPCMV01", HTPCBinaryInput::iMagicSize);
+
+  long iNbEvents = 0, iNbSites = 0;
+  int32_t iEventId;
+  int32_t iNbSitesOfEvent;
+  std::vector<float> hSites;
+  while(hInput >> iEventId >> iNbSitesOfEvent)
+    {
+      if(iNbSitesOfEvent < 0)
+        {
+          std::cerr << "htpcConvert: negative number of sites in event " << iEventId << std::endl;
+          return 1;
+        }
+
+      hSites.resize(7 * (size_t) iNbSitesOfEvent);
+      for(size_t i = 0; i < hSites.size(); i++)
+        if(!(hInput >> hSites[i]))
+          {
+            std::cerr << "htpcConvert: " << hInputFilename << " ends in event " << iEventId << std::endl;
+            return 1;
+          }
+
+      const uint32_t iNbSitesOut = iNbSitesOfEvent;
+      hOutput.write(reinterpret_cast<const char *>(&iEventId), sizeof(iEventId));
+      hOutput.write(reinterpret_cast<const char *>(&iNbSitesOut), sizeof(iNbSitesOut));
+      if(!hSites.empty())
+        hOutput.write(reinterpret_cast<const char *>(&hSites[0]), hSites.size() * sizeof(float));
+
+      iNbEvents++;
+      iNbSites += iNbSitesOfEvent;
+    }
+
+  if(!hInput.eof())
+    {
+      std::cerr << "htpcConvert: cannot parse " << hInputFilename << " after " << iNbEvents << " events" << std::endl;
+      return 1;
+    }
+
+  hOutput.close();
+  if(!hOutput)
+    {
+      std::cerr << "htpcConvert: cannot write " << hOutputFilename << std::endl;
+      return 1;
+    }
+
+  std::cout << "htpcConvert: " << iNbEvents << " events, " << iNbSites << " sites written to "
+            << hOutputFilename << std::endl;
+  return 0;
+}
+
+// 2 integers and 7 numbers per muon
+int
+ConvertMuon(const std::string &hInputFilename, const std::string &hOutputFilename)
+{
+  std::ifstream hInput(hInputFilename.c_str());
+  if(!hInput)
+    {
+      std::cerr << "htpcConvert: cannot open " << hInputFilename << std::endl;
+      return 1;
+    }
+
+  std::ofstream hOutput(hOutputFilename.c_str(), std::ios::binary | std::ios::trunc);
+  if(!hOutput)
+    {
+      std::cerr << "htpcConvert: cannot open " << hOutputFilename << std::endl;
+      return 1;
+    }
+  hOutput.write("HTPCMU01", HTPCBinaryInput::iMagicSize);
+
+  long iNbMuons = 0;
+  int32_t piRecord[2];
+  float pfRecord[7];
+  while(hInput >> piRecord[0] >> piRecord[1])
+    {
+      for(int i = 0; i < 7; i++)
+        if(!(hInput >> pfRecord[i]))
+          {
+            std::cerr << "htpcConvert: " << hInputFilename << " ends in muon " << iNbMuons << std::endl;
+            return 1;
+          }
+
+      hOutput.write(reinterpret_cast<const char *>(piRecord), sizeof(piRecord));
+      hOutput.write(reinterpret_cast<const char *>(pfRecord), sizeof(pfRecord));
+      iNbMuons++;
+    }
+
+  if(!hInput.eof())
+    {
+      std::cerr << "htpcConvert: cannot parse " << hInputFilename << " after " << iNbMuons << " muons" << std::endl;
+      return 1;
+    }
+
+  hOutput.close();
+  if(!hOutput)
+    {
+      std::cerr << "htpcConvert: cannot write " << hOutputFilename << std::endl;
+      return 1;
+    }
+
+  std::cout << "htpcConvert: " << iNbMuons << " muons written to " << hOutputFilename << std::endl;
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  if(argc != 4)
+    usage();
+
+  std::string hFormat = argv[1];
+  if(hFormat == "multivertex")
+    return ConvertMultiVertex(argv[2], argv[3]);
+  if(hFormat == "muon")
+    return ConvertMuon(argv[2], argv[3]);
+
+  usage();
+  return 1;
+}
+
+void
+usage()
+{
+  std::cerr << "usage: htpcConvert multivertex|muon <input.txt> <output.bin>" << std::endl;
+  exit(1);
+}
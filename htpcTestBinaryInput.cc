@@ -0,0 +1,195 @@
+// Checks of the binary generator inputs (htpcConvert, HTPCBinaryInput), run
+// by ctest:
+//
+//   htpcTestBinaryInput <htpcConvert> [scratch directory]
+//
+// Returns the number of failed checks.
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "HTPCBinaryInput.hh"
+
+namespace {
+
+int iNbFailures = 0;
+
+void
+Check(bool bCondition, const std::string &hWhat)
+{
+  std::cout << (bCondition ? "ok      " : "FAILED  ") << hWhat << std::endl;
+  if(!bCondition)
+    iNbFailures++;
+}
+
+std::string hConvert;
+
+int
+Convert(const std::string &hFormat, const std::string &hInput, const std::string &hOutput)
+{
+  std::string hCommand = "\"" + hConvert + "\" " + hFormat + " \"" + hInput + "\" \"" + hOutput + "\"";
+  return std::system(hCommand.c_str());
+}
+
+struct Event {
+  int32_t iEventId;
+  std::vector<float> hSites;
+};
+
+Event
+ReadEvent(HTPCBinaryInput &hInput)
+{
+  Event hEvent;
+  uint32_t iNbSites;
+  hInput.Read(&hEvent.iEventId);
+  hInput.Read(&iNbSites);
+  hEvent.hSites.resize(7 * (size_t) iNbSites);
+  if(iNbSites)
+    hInput.Read(&hEvent.hSites[0], hEvent.hSites.size());
+  return hEvent;
+}
+
+void
+CheckMultiVertex(const std::string &hScratch)
+{
+  const std::string hText = hScratch + "/htpcTestBinaryInput_mv.txt";
+  const std::string hBinary = hScratch + "/htpcTestBinaryInput_mv.bin";
+  std::ofstream(hText.c_str())
+    << "0 2\n1 2 3 0 100 0 0\n-1 -2 -3 5 200 1 0\n"
+    << "1 0\n"
+    << "7 1\n10.5 20.5 -30.5 1000 3000 0 250\n";
+  Check(Convert("multivertex", hText, hBinary) == 0, "multivertex text is converted");
+
+  HTPCBinaryInput hInput;
+  hInput.Open(hBinary, "HTPCMV01");
+  Check(hInput.GetPosition() == HTPCBinaryInput::iMagicSize, "cursor starts after the magic");
+  Check(hInput.GetSize() == 8 + (8 + 2*28) + 8 + (8 + 28), "multivertex file has the expected size");
+
+  Event hFirst = ReadEvent(hInput);
+  Check(hFirst.iEventId == 0 && hFirst.hSites.size() == 14 && hFirst.hSites[7] == -1.f
+        && hFirst.hSites[12] == 1.f, "first event is read back");
+  Event hEmpty = ReadEvent(hInput);
+  Check(hEmpty.iEventId == 1 && hEmpty.hSites.empty(), "event without sites is read back");
+  const size_t iThirdPosition = hInput.GetPosition();
+  Event hThird = ReadEvent(hInput);
+  Check(hThird.iEventId == 7 && hThird.hSites.size() == 7 && hThird.hSites[2] == -30.5f
+        && hThird.hSites[6] == 250.f, "last event is read back");
+  Check(hInput.AtEnd(), "cursor is at the end after the last event");
+
+  // the generators start again at the end of the file
+  hInput.Rewind();
+  Check(ReadEvent(hInput).iEventId == 0, "file wraps to the first event");
+  hInput.Seek(iThirdPosition);
+  Check(ReadEvent(hInput).iEventId == 7, "seek to an event");
+
+  bool bRejected = false;
+  try {
+    int32_t iValue;
+    hInput.Read(&iValue);
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "read beyond the end is rejected");
+
+  bRejected = false;
+  try {
+    hInput.Seek(hInput.GetSize() + 1);
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "seek beyond the end is rejected");
+
+  bRejected = false;
+  try {
+    HTPCBinaryInput hOther;
+    hOther.Open(hBinary, "HTPCMU01");
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "file of another format is rejected");
+
+  const std::string hBadText = hScratch + "/htpcTestBinaryInput_mv_bad.txt";
+  std::ofstream(hBadText.c_str()) << "0 2\n1 2 3 0 100 0 0\n";
+  Check(Convert("multivertex", hBadText, hBinary) != 0, "multivertex text ending in an event is rejected");
+}
+
+// fixed records of 2 int32 and 7 floats, as Xenon1tMuonGenerator reads them
+const size_t iMuonRecordSize = 2 * sizeof(int32_t) + 7 * sizeof(float);
+
+void
+ReadMuon(HTPCBinaryInput &hInput, int32_t *piRecord, float *pfRecord)
+{
+  // the generator starts again at the end of the file
+  if(hInput.GetSize() - hInput.GetPosition() < iMuonRecordSize)
+    hInput.Rewind();
+  hInput.Read(piRecord, 2);
+  hInput.Read(pfRecord, 7);
+}
+
+void
+CheckMuon(const std::string &hScratch)
+{
+  const int iNbMuons = 50;
+  const std::string hText = hScratch + "/htpcTestBinaryInput_mu.txt";
+  const std::string hBinary = hScratch + "/htpcTestBinaryInput_mu.bin";
+  {
+    std::ofstream hOutput(hText.c_str());
+    for(int i = 0; i < iNbMuons; i++)
+      hOutput << i << " " << 10 + i % 2 << " " << 1.5 * i << " 0 0 0 0.6 0 " << -0.8 << "\n";
+  }
+  Check(Convert("muon", hText, hBinary) == 0, "muon text is converted");
+
+  HTPCBinaryInput hInput;
+  hInput.Open(hBinary, "HTPCMU01", 64);
+  Check(hInput.GetSize() == HTPCBinaryInput::iMagicSize + iNbMuons * iMuonRecordSize,
+        "muon file has fixed size records");
+
+  // random access to a record, as /xe/gun/muonstartrecord does
+  int32_t piRecord[2];
+  float pfRecord[7];
+  hInput.Seek(HTPCBinaryInput::iMagicSize + 37 * iMuonRecordSize);
+  ReadMuon(hInput, piRecord, pfRecord);
+  Check(piRecord[0] == 37 && piRecord[1] == 11 && pfRecord[0] == 55.5f && pfRecord[4] == 0.6f
+        && pfRecord[6] == -0.8f, "seek to a muon record");
+
+  bool bInOrder = true;
+  for(int i = 38; i < iNbMuons + 3; i++)
+    {
+      ReadMuon(hInput, piRecord, pfRecord);
+      bInOrder = bInOrder && piRecord[0] == i % iNbMuons && pfRecord[0] == 1.5f * (i % iNbMuons);
+    }
+  Check(bInOrder, "muon records wrap to the start of the file");
+
+  // backwards seek after the prefetch window moved on
+  hInput.Seek(HTPCBinaryInput::iMagicSize + 1 * iMuonRecordSize);
+  ReadMuon(hInput, piRecord, pfRecord);
+  Check(piRecord[0] == 1 && piRecord[1] == 11, "seek back to a muon record");
+
+  const std::string hBadText = hScratch + "/htpcTestBinaryInput_mu_bad.txt";
+  std::ofstream(hBadText.c_str()) << "0 10 1 0 0 0 0.6 0\n";
+  Check(Convert("muon", hBadText, hBinary) != 0, "muon text ending in a record is rejected");
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  if(argc < 2)
+    {
+      std::cerr << "usage: htpcTestBinaryInput <htpcConvert> [scratch directory]" << std::endl;
+      return 1;
+    }
+  hConvert = argv[1];
+  const std::string hScratch = argc > 2 ? argv[2] : ".";
+
+  CheckMultiVertex(hScratch);
+  CheckMuon(hScratch);
+
+  return iNbFailures;
+}
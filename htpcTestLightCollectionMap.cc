@@ -0,0 +1,117 @@
+// Checks of the light collection map file (HTPCLightCollectionMap), run by
+// ctest:
+//
+//   htpcTestLightCollectionMap [scratch directory]
+//
+// Returns the number of failed checks.
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "HTPCLightCollectionMap.hh"
+
+namespace {
+
+int iNbFailures = 0;
+
+void
+Check(bool bCondition, const std::string &hWhat)
+{
+  std::cout << (bCondition ? "ok      " : "FAILED  ") << hWhat << std::endl;
+  if(!bCondition)
+    iNbFailures++;
+}
+
+std::vector<char>
+ReadBytes(const std::string &hFilename)
+{
+  std::ifstream hFile(hFilename.c_str(), std::ios::binary | std::ios::ate);
+  std::vector<char> hBytes((size_t) hFile.tellg());
+  hFile.seekg(0);
+  hFile.read(&hBytes[0], hBytes.size());
+  return hBytes;
+}
+
+bool
+IsRejected(const std::string &hFilename, const std::vector<char> &hBytes)
+{
+  std::ofstream(hFilename.c_str(), std::ios::binary).write(&hBytes[0], hBytes.size());
+  HTPCLightCollectionMap hMap;
+  try {
+    hMap.Load(hFilename);
+  } catch (const std::runtime_error &) {
+    return !hMap.IsLoaded();
+  }
+  return false;
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  const std::string hScratch = argc > 1 ? argv[1] : ".";
+  const std::string hFilename = hScratch + "/htpcTestLightCollectionMap.lce";
+
+  const unsigned piNbBins[3] = {2, 3, 4};
+  const double pdMin[3] = {-10., -15., 0.};
+  const double pdMax[3] = {10., 15., 40.};
+  {
+    HTPCLightCollectionMap hMap;
+    hMap.Book(piNbBins, pdMin, pdMax, 5);
+    hMap.AddEmitted(0, 100);
+    hMap.AddDetected(0, 4, 25);
+    hMap.AddDetected(0, 1, 10);
+    hMap.AddEmitted(23, 10);
+    hMap.AddDetected(23, 2, 5);
+    hMap.Write(hFilename);
+  }
+
+  HTPCLightCollectionMap hMap;
+  hMap.Load(hFilename);
+  Check(hMap.IsLoaded() && hMap.GetNbVoxels() == 24 && hMap.GetNbPMTs() == 5,
+        "grid is read back");
+  Check(hMap.GetLastEntry(0) - hMap.GetFirstEntry(0) == 2
+        && hMap.GetLastEntry(1) == hMap.GetFirstEntry(1) && hMap.GetLastEntry(23) == 3,
+        "only the PMTs that saw light are stored");
+  bool bFound = false;
+  for(size_t i = hMap.GetFirstEntry(0); i < hMap.GetLastEntry(0); i++)
+    bFound = bFound || (hMap.GetPMT(i) == 4 && hMap.GetProbability(i) == 0.25f);
+  Check(bFound, "probability is detected over emitted photons");
+  Check(hMap.FindVoxel(-9., -14., 1.) == 0 && hMap.FindVoxel(9., 14., 39.) == 23
+        && hMap.FindVoxel(11., 0., 0.) == -1, "points are found in the grid");
+
+  // header: magic, nx, ny, nz, npmts
+  const std::vector<char> hBytes = ReadBytes(hFilename);
+  const std::string hBadFilename = hScratch + "/htpcTestLightCollectionMap_bad.lce";
+
+  // 2^11 bins on each axis give 2^33 voxels, 0 in 32 bits
+  std::vector<char> hOverflow(hBytes);
+  const uint32_t iLargeNbBins = 2048;
+  for(int i = 0; i < 3; i++)
+    std::memcpy(&hOverflow[8 + 4 * i], &iLargeNbBins, 4);
+  Check(IsRejected(hBadFilename, hOverflow), "grid larger than the file is rejected");
+
+  std::vector<char> hSmallGrid(hBytes);
+  const uint32_t iSmallNbBins = 1;
+  std::memcpy(&hSmallGrid[8], &iSmallNbBins, 4);
+  Check(IsRejected(hBadFilename, hSmallGrid), "grid smaller than the file is rejected");
+
+  std::vector<char> hFewPMTs(hBytes);
+  const uint32_t iNbPMTs = 1;
+  std::memcpy(&hFewPMTs[20], &iNbPMTs, 4);
+  Check(IsRejected(hBadFilename, hFewPMTs), "more entries than voxels times PMTs are rejected");
+
+  Check(IsRejected(hBadFilename, std::vector<char>(hBytes.begin(), hBytes.end() - 1)),
+        "truncated map is rejected");
+  std::vector<char> hLonger(hBytes);
+  hLonger.push_back(0);
+  Check(IsRejected(hBadFilename, hLonger), "trailing bytes are rejected");
+
+  return iNbFailures;
+}
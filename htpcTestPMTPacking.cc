@@ -0,0 +1,90 @@
+// Checks of the PMT array layouts (HTPCPMTPacking), run by ctest:
+//
+//   htpcTestPMTPacking [scratch directory]
+//
+// Returns the number of failed checks.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "HTPCPMTPacking.hh"
+
+namespace {
+
+int iNbFailures = 0;
+
+void
+Check(bool bCondition, const std::string &hWhat)
+{
+  std::cout << (bCondition ? "ok      " : "FAILED  ") << hWhat << std::endl;
+  if(!bCondition)
+    iNbFailures++;
+}
+
+// defaults of HTPCDetectorConstruction, in mm
+const double dTPCRadius = 1500.;
+const double dPMTRadius = 76.2 / 2;
+const double dPitch = 81.;
+
+}
+
+int
+main(int argc, char **argv)
+{
+  const std::string hScratch = argc > 1 ? argv[1] : ".";
+
+  // default geometry: hexagonal grid at 81 mm filling the TPC
+  std::vector<HTPCPMTPacking::Position> hHex =
+    HTPCPMTPacking::Generate(HTPCPMTPacking::ParseLayout("hex"), dTPCRadius, dPMTRadius, dPitch);
+  Check(hHex.size() == 1184, "hex layout at 81 mm pitch has 1184 PMTs");
+  Check(HTPCPMTPacking::MinimumDistance(hHex) >= dPitch - 1.e-6, "hex layout keeps the pitch");
+  Check(HTPCPMTPacking::Hexagonal(dTPCRadius, dPMTRadius, dPitch, 100).size() == 100,
+        "hex layout stops at the requested number");
+
+  // rings never closer than the pitch, whatever the pitch
+  for(double dRingPitch : {78., 81., 90., 120.})
+    {
+      std::vector<HTPCPMTPacking::Position> hRings =
+        HTPCPMTPacking::Rings(dTPCRadius, dPMTRadius, dRingPitch);
+      Check(hRings.size() > 1 && HTPCPMTPacking::MinimumDistance(hRings) >= dRingPitch - 1.e-6,
+            "rings layout keeps the " + std::to_string((int) dRingPitch) + " mm pitch");
+    }
+
+  // layout files: comments, both separators, and malformed lines
+  const std::string hGoodFilename = hScratch + "/htpcTestPMTPacking_good.txt";
+  std::ofstream(hGoodFilename.c_str()) << "# x, y\n0,0\n\n100 0 # right\n0, 100\n";
+  std::vector<HTPCPMTPacking::Position> hFromFile = HTPCPMTPacking::FromFile(hGoodFilename);
+  Check(hFromFile.size() == 3 && hFromFile[1].x == 100. && hFromFile[2].y == 100.,
+        "layout file is read");
+
+  const std::string hBadFilename = hScratch + "/htpcTestPMTPacking_bad.txt";
+  std::ofstream(hBadFilename.c_str()) << "0,0\n100,abc\n";
+  bool bRejected = false;
+  try {
+    HTPCPMTPacking::FromFile(hBadFilename);
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "malformed layout file is rejected");
+
+  bRejected = false;
+  try {
+    HTPCPMTPacking::FromFile(hScratch + "/htpcTestPMTPacking_missing.txt");
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "missing layout file is rejected");
+
+  bRejected = false;
+  try {
+    HTPCPMTPacking::ParseLayout("square");
+  } catch (const std::invalid_argument &) {
+    bRejected = true;
+  }
+  Check(bRejected, "unknown layout is rejected");
+
+  return iNbFailures;
+}
@@ -0,0 +1,112 @@
+// Checks of the phase space file (HTPCPhaseSpaceWriter) as the phasespace
+// generator maps it (HTPCBinaryInput), run by ctest:
+//
+//   htpcTestPhaseSpace [scratch directory]
+//
+// Returns the number of failed checks.
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HTPCBinaryInput.hh"
+#include "HTPCPhaseSpaceWriter.hh"
+
+namespace {
+
+int iNbFailures = 0;
+
+void
+Check(bool bCondition, const std::string &hWhat)
+{
+  std::cout << (bCondition ? "ok      " : "FAILED  ") << hWhat << std::endl;
+  if(!bCondition)
+    iNbFailures++;
+}
+
+HTPCPhaseSpaceWriter::Record
+MakeRecord(int32_t iEventId, int32_t iPDGCode, float fValue)
+{
+  HTPCPhaseSpaceWriter::Record hRecord = {iEventId, iPDGCode, fValue, -fValue, 2*fValue,
+                                          0.f, 0.6f, -0.8f, 10*fValue, 3*fValue, 0.25f};
+  return hRecord;
+}
+
+bool
+Equal(const HTPCPhaseSpaceWriter::Record &hA, const HTPCPhaseSpaceWriter::Record &hB)
+{
+  return !std::memcmp(&hA, &hB, sizeof(HTPCPhaseSpaceWriter::Record));
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  const std::string hScratch = argc > 1 ? argv[1] : ".";
+  const std::string hFilename = hScratch + "/htpcTestPhaseSpace.phasespace";
+
+  // particles of events 2 and 5 out of 6 first stage events
+  std::vector<HTPCPhaseSpaceWriter::Record> hWritten;
+  hWritten.push_back(MakeRecord(2, 2112, 1.f));
+  hWritten.push_back(MakeRecord(2, 22, 2.f));
+  hWritten.push_back(MakeRecord(5, 1000822080, 3.f));
+  const int iNbEvents = 6;
+
+  {
+    // a buffer smaller than a record flushes on every fill
+    HTPCPhaseSpaceWriter hWriter;
+    hWriter.Open(hFilename, 16);
+    size_t iRecord = 0;
+    for(int iEvent = 0; iEvent < iNbEvents; iEvent++)
+      {
+        while(iRecord < hWritten.size() && hWritten[iRecord].iEventId == iEvent)
+          hWriter.Fill(hWritten[iRecord++]);
+        hWriter.AddEvent(iEvent == 5 ? 2. : 0.5);
+      }
+    Check(hWriter.GetNbRecords() == hWritten.size() && hWriter.GetNbEvents() == iNbEvents
+          && hWriter.GetTotalWeight() == 4.5, "records and exposure are counted");
+    hWriter.Close();
+  }
+
+  HTPCBinaryInput hInput;
+  hInput.Open(hFilename, HTPCPhaseSpaceWriter::szMagic);
+  const size_t iDataEnd = HTPCBinaryInput::iMagicSize + hWritten.size() * sizeof(HTPCPhaseSpaceWriter::Record);
+  Check(hInput.GetSize() == iDataEnd + sizeof(HTPCPhaseSpaceWriter::Exposure),
+        "file holds the records and the exposure");
+
+  bool bEqual = true;
+  HTPCPhaseSpaceWriter::Record hRecord;
+  for(size_t i = 0; i < hWritten.size(); i++)
+    {
+      hInput.Read(&hRecord);
+      bEqual = bEqual && Equal(hRecord, hWritten[i]);
+    }
+  Check(bEqual && hInput.GetPosition() == iDataEnd, "records are mapped back");
+
+  HTPCPhaseSpaceWriter::Exposure hExposure;
+  hInput.Read(&hExposure);
+  Check(!std::memcmp(hExposure.szTag, HTPCPhaseSpaceWriter::szExposureTag, 8)
+        && hExposure.iNbEvents == iNbEvents && hExposure.dWeight == 4.5,
+        "exposure of the events without particles is kept");
+  Check(hInput.AtEnd(), "exposure ends the file");
+
+  // the generator replays the file again from the first record
+  hInput.Rewind();
+  hInput.Read(&hRecord);
+  Check(Equal(hRecord, hWritten[0]), "file wraps to the first record");
+
+  // an empty first stage still has its exposure
+  {
+    HTPCPhaseSpaceWriter hWriter;
+    hWriter.Open(hFilename);
+    hWriter.AddEvent(1.);
+  }
+  hInput.Open(hFilename, HTPCPhaseSpaceWriter::szMagic);
+  hInput.Read(&hExposure);
+  Check(hInput.AtEnd() && hExposure.iNbEvents == 1 && hExposure.dWeight == 1.,
+        "file is complete when destroyed without Close()");
+
+  return iNbFailures;
+}
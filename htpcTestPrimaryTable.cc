@@ -0,0 +1,132 @@
+// Checks of the primary table side file (HTPCPrimaryTable), run by ctest:
+//
+//   htpcTestPrimaryTable [scratch directory]
+//
+// Returns the number of failed checks.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "HTPCPrimaryTable.hh"
+
+namespace {
+
+int iNbFailures = 0;
+
+void
+Check(bool bCondition, const std::string &hWhat)
+{
+  std::cout << (bCondition ? "ok      " : "FAILED  ") << hWhat << std::endl;
+  if(!bCondition)
+    iNbFailures++;
+}
+
+HTPCPrimaryTable::Record
+MakeRecord(int64_t iEventId, float fValue)
+{
+  HTPCPrimaryTable::Record hRecord = {iEventId, fValue, -fValue, 2*fValue, 0.f, 0.6f, 0.8f,
+                                      10*fValue, 0.5f};
+  return hRecord;
+}
+
+bool
+Equal(const HTPCPrimaryTable::Record &hA, const HTPCPrimaryTable::Record &hB)
+{
+  return hA.iEventId == hB.iEventId && hA.fX == hB.fX && hA.fY == hB.fY && hA.fZ == hB.fZ
+    && hA.fCx == hB.fCx && hA.fCy == hB.fCy && hA.fCz == hB.fCz
+    && hA.fEnergy == hB.fEnergy && hA.fWeight == hB.fWeight;
+}
+
+long
+FileSize(const std::string &hFilename)
+{
+  std::ifstream hFile(hFilename.c_str(), std::ios::binary | std::ios::ate);
+  return hFile ? (long) hFile.tellg() : -1;
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  const std::string hScratch = argc > 1 ? argv[1] : ".";
+  const std::string hFilename = hScratch + "/htpcTestPrimaryTable.primaries";
+
+  // event ids with deltas of 1, 0 (second primary of an event), 0x7f, 0x80,
+  // 0x3fff and 0x4000, i.e. varints of 1, 2 and 3 bytes
+  const int64_t piEventIds[] = {0, 0, 0x7f, 0xff, 0x40fe, 0x80fe, 0x80fe};
+  const size_t iNbRecordBytes = 32;
+  const long iExpectedSize = 8 + (1+1+1+2+2+3+1) + 7 * iNbRecordBytes;
+
+  std::vector<HTPCPrimaryTable::Record> hWritten;
+  for(size_t i = 0; i < sizeof(piEventIds) / sizeof(piEventIds[0]); i++)
+    hWritten.push_back(MakeRecord(piEventIds[i], 1.5f * i));
+
+  {
+    // a buffer smaller than a record flushes on every fill
+    HTPCPrimaryTable hTable;
+    hTable.Open(hFilename, 16);
+    for(size_t i = 0; i < hWritten.size(); i++)
+      hTable.Fill(hWritten[i]);
+    Check(hTable.GetNbRecords() == hWritten.size(), "records are counted");
+
+    bool bRejected = false;
+    try {
+      hTable.Fill(MakeRecord(3, 0.f));
+    } catch (const std::invalid_argument &) {
+      bRejected = true;
+    }
+    Check(bRejected, "decreasing event id is rejected");
+    hTable.Close();
+  }
+  Check(FileSize(hFilename) == iExpectedSize, "varint deltas take 1, 2 and 3 bytes");
+
+  std::vector<HTPCPrimaryTable::Record> hRead;
+  HTPCPrimaryTable::Read(hFilename, hRead);
+  bool bEqual = hRead.size() == hWritten.size();
+  for(size_t i = 0; bEqual && i < hRead.size(); i++)
+    bEqual = Equal(hRead[i], hWritten[i]);
+  Check(bEqual, "records are read back");
+
+  // the default buffer only writes at Close()
+  {
+    HTPCPrimaryTable hTable;
+    hTable.Open(hFilename);
+    for(size_t i = 0; i < hWritten.size(); i++)
+      hTable.Fill(hWritten[i]);
+  }
+  HTPCPrimaryTable::Read(hFilename, hRead);
+  Check(hRead.size() == hWritten.size() && Equal(hRead.back(), hWritten.back()),
+        "table is complete when destroyed without Close()");
+
+  // cut in the middle of the last record
+  const std::string hTruncatedFilename = hScratch + "/htpcTestPrimaryTable_truncated.primaries";
+  {
+    std::ifstream hInput(hFilename.c_str(), std::ios::binary);
+    std::vector<char> hBytes(iExpectedSize - 5);
+    hInput.read(&hBytes[0], hBytes.size());
+    std::ofstream(hTruncatedFilename.c_str(), std::ios::binary).write(&hBytes[0], hBytes.size());
+  }
+  bool bRejected = false;
+  try {
+    HTPCPrimaryTable::Read(hTruncatedFilename, hRead);
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "truncated table is rejected");
+
+  const std::string hOtherFilename = hScratch + "/htpcTestPrimaryTable_other.txt";
+  std::ofstream(hOtherFilename.c_str()) << "not a primary table\n";
+  bRejected = false;
+  try {
+    HTPCPrimaryTable::Read(hOtherFilename, hRead);
+  } catch (const std::runtime_error &) {
+    bRejected = true;
+  }
+  Check(bRejected, "file without magic is rejected");
+
+  return iNbFailures;
+}
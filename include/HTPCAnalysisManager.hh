@@ -8,14 +8,36 @@
 #include <G4Timer.hh>
 #include <G4ThreeVector.hh>
 
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "HTPCAsyncQueue.hh"
+#include "HTPCDetectorHit.hh"
+#include "HTPCSignalSynthesis.hh"
+
+using std::map;
+using std::vector;
+
 class G4Run;
 class G4Event;
 class G4Step;
+class G4ParticleDefinition;
+class G4VPhysicalVolume;
 
 class TFile;
 class TTree;
+class TH1F;
+class TH2F;
 
+class HTPCAnalysisMessenger;
 class HTPCEventData;
+class HTPCLightCollectionMap;
+class HTPCParquetWriter;
+class HTPCPhaseSpaceWriter;
+class HTPCPrimaryTable;
 class HTPCPrimaryGeneratorAction;
 
 class HTPCAnalysisManager
@@ -34,11 +56,105 @@ public:
   void SetDataFilename(const G4String &hFilename) { m_hDataFilename = hFilename; }
   void SetNbEventsToSimulate(G4int iNbEventsToSimulate) { m_iNbEventsToSimulate = iNbEventsToSimulate;}
 
+  // events without hits are only counted unless written (/run/writeEmpty)
+  void SetWriteEmptyEvents(G4bool bWrite) { writeEmptyEvents = bWrite; }
+
+  // photon counts per PMT from a light collection map (/htpc/signal/)
+  void SetLightCollectionMap(const G4String &hFilename);
+
+  // S1/S2 per interaction (/htpc/signal/synthesis, off by default), the
+  // liquid level defaults to the top of the active liquid xenon
+  void SetSignalSynthesis(G4bool bEnable) { m_bSignalSynthesis = bEnable; }
+  HTPCSignalSynthesis *GetSignalSynthesis() { return m_pSignalSynthesis; }
+  void SetLiquidLevel(G4double dZ) { m_pSignalSynthesis->SetLiquidLevel(dZ); m_bLiquidLevelSet = true; }
+
+  // only events passing the filter are written (/htpc/filter/), the number
+  // of events passing each cut is stored in the output file
+  enum ScatterSelection { kAnyScatter, kSingleScatter, kMultipleScatter };
+  void SetFilter(G4bool bEnable) { m_bFilter = bEnable; }
+  void SetScatterSelection(ScatterSelection iSelection) { m_iScatterSelection = iSelection; }
+  void SetScatterThreshold(G4double dEnergy) { m_dScatterThreshold = dEnergy; }
+  void SetFiducialRadius(G4double dRadius) { m_dFiducialRadius = dRadius; }
+  void SetFiducialZ(G4double dZMin, G4double dZMax) { m_dFiducialZMin = dZMin; m_dFiducialZMax = dZMax; }
+  void SetEnergyWindow(G4double dEMin, G4double dEMax) { m_dEnergyMin = dEMin; m_dEnergyMax = dEMax; }
+
+  // histograms instead of the event tree (/htpc/output/mode): spectra of the
+  // total and cluster energies, single scatters in the fiducial volume of the
+  // filter, cluster positions. The parquet mode writes steps and primaries as
+  // Parquet tables (HTPCParquetWriter, -DWITH_ARROW=ON builds only).
+  enum OutputMode { kTree, kHistograms, kParquet };
+  void SetOutputMode(OutputMode iMode) { m_iOutputMode = iMode; }
+  void SetParquetBatchSize(G4int iNbSteps) { m_iParquetBatchSize = iNbSteps; }
+
+  // tree output from a writer thread that owns the file, fed with at most
+  // iQueueSize completed events (/htpc/output/asyncWrite)
+  void SetAsyncWrite(G4bool bEnable) { m_bAsyncWrite = bEnable; }
+  void SetAsyncQueueSize(G4int iQueueSize) { m_iAsyncQueueSize = iQueueSize; }
+
+  // every primary particle of every event, written or not, in a compact side file
+  // <output file>.primaries (HTPCPrimaryTable, /htpc/output/primaryTable)
+  void SetPrimaryTable(G4bool bEnable) { m_bPrimaryTable = bEnable; }
+
+  // first stage of a two-stage simulation (/htpc/phasespace/): particles of
+  // the selected types ("neutron gamma" by default, "all") entering the
+  // volume from outside are written to <output file>.phasespace
+  // (HTPCPhaseSpaceWriter) and stopped there, unless SetPhaseSpaceStop(false).
+  // The phasespace generator replays them.
+  void SetPhaseSpaceVolume(const G4String &hVolumeName) { m_hPhaseSpaceVolumeName = hVolumeName; }
+  void SetPhaseSpaceParticles(const G4String &hParticleNames) { m_hPhaseSpaceParticleNames = hParticleNames; }
+  void SetPhaseSpaceStop(G4bool bStop) { m_bPhaseSpaceStop = bStop; }
+  G4VPhysicalVolume *GetPhaseSpaceVolume() const { return m_pPhaseSpaceVolume; }
+  // step entering the phase space volume, true if the track is to be stopped
+  G4bool AddPhaseSpaceParticle(const G4Step *pStep);
+
+  // storage of the event tree: compression of the file ("none", "zlib",
+  // "lzma", "lz4", "zstd" and a level), basket sizes for the branches
+  // matching a pattern (wildcards allowed), entries per cluster (< 0: bytes),
+  // and the "fastWrite", "smallArchive" or "default" presets
+  void SetCompression(const G4String &hAlgorithm, G4int iLevel);
+  void AddBasketSize(const G4String &hBranches, G4int iBytes)
+    { m_hBasketSizes.push_back(std::make_pair(hBranches, iBytes)); }
+  void SetAutoFlush(G4int iEntries) { m_iAutoFlush = iEntries; m_bAutoFlushSet = true; }
+  void SetOutputPreset(const G4String &hPreset);
+
+  // branches of the event tree: rules are applied in order and the last one
+  // matching a branch (wildcards allowed) decides. Step quantities that are
+  // not written are not copied either. Profiles "full", "minimal", "signal".
+  void KeepBranches(const G4String &hPattern) { m_hBranchRules.push_back(std::make_pair(hPattern, true)); }
+  void DropBranches(const G4String &hPattern) { m_hBranchRules.push_back(std::make_pair(hPattern, false)); }
+  void SetBranchProfile(const G4String &hProfile);
+  void SetHistogramEnergyBinning(G4int iNbBins, G4double dEnergyMax)
+    { m_iHistogramEnergyBins = iNbBins; m_dHistogramEnergyMax = dEnergyMax; }
+
+  // optical calibration runs (lightmap generator): photons reaching the PMT
+  // windows are counted into a new light collection map
+  void SetLightCollectionMapOutput(const G4String &hFilename) { m_hLightCollectionMapOutput = hFilename; }
+  G4bool IsLightMapCalibration() const { return m_pLightMapCalibration != 0; }
+  // PMT window volume, looked up once at the start of a calibration run
+  G4VPhysicalVolume *GetPMTWindow() const { return m_pPMTWindow; }
+  void AddDetectedPhoton(G4int iPMT);
+
   void FillParticleInSave(G4int flag, G4int partPDGcode, G4ThreeVector pos, G4ThreeVector dir, G4float nrg, G4float time, G4int trackID);
 
 
 private:
   G4bool FilterEvent(HTPCEventData *pEventData);
+  G4int CountScatters(HTPCEventData *pEventData, G4bool &bFiducial, G4double &dEnergy);
+  void BookTree();
+  void BookHistograms();
+  void OpenParquetWriter();
+  void OpenOutputFile();
+  void CloseOutputFile(G4double dt, G4int seed);
+  void FillTree();
+  void FreeRecords();
+  G4bool IsBranchSelected(const char *szBranch) const;
+  void SelectStepQuantities();
+  void ResizeSteps(size_t iNbSteps);
+  void FillHistograms(HTPCEventData *pEventData);
+  void FillPrimaryTable(const G4Event *pEvent);
+  void FillPMTHits(HTPCDetectorHitsCollection *pDetectorHitsCollection, G4int iNbDetectorHits);
+  void FillClusters(HTPCDetectorHitsCollection *pDetectorHitsCollection, G4int iNbDetectorHits);
+  G4bool IsNuclearRecoil(const G4String &hParticleType);
 
 private:
   G4int m_iDetectorHitsCollectionID;
@@ -59,6 +175,81 @@ private:
 
   G4Timer *runTime;
   G4bool            writeEmptyEvents;
+  G4int m_iNbEmptyEvents;
+
+  G4bool m_bPrimaryTable;
+  HTPCPrimaryTable *m_pPrimaryTable;
+
+  G4String m_hPhaseSpaceVolumeName;
+  G4bool m_bPhaseSpaceStop;
+  G4String m_hPhaseSpaceParticleNames;
+  vector<const G4ParticleDefinition *> m_hPhaseSpaceParticles;   // empty: all
+  G4VPhysicalVolume *m_pPhaseSpaceVolume;
+  HTPCPhaseSpaceWriter *m_pPhaseSpaceWriter;
+
+  HTPCAnalysisMessenger *m_pMessenger;
+
+  HTPCLightCollectionMap *m_pLightCollectionMap;
+  vector<G4double> m_hExpectedPMTHits;
+
+  HTPCLightCollectionMap *m_pLightMapCalibration;
+  G4VPhysicalVolume *m_pPMTWindow;
+  G4String m_hLightCollectionMapOutput;
+
+  G4bool m_bSignalSynthesis;
+  HTPCSignalSynthesis *m_pSignalSynthesis;
+  G4bool m_bLiquidLevelSet;
+  vector<HTPCSignalSynthesis::Deposit> m_hDeposits;
+  vector<HTPCSignalSynthesis::Cluster> m_hClusters;
+  map<G4String, G4bool> m_hNuclearRecoilTypes;
+
+  G4bool m_bFilter;
+  ScatterSelection m_iScatterSelection;
+  G4double m_dScatterThreshold;           // clusters below do not count as scatters
+  G4double m_dFiducialRadius;
+  G4double m_dFiducialZMin;
+  G4double m_dFiducialZMax;
+  G4double m_dEnergyMin;
+  G4double m_dEnergyMax;
+  G4int m_iNbFilteredEvents;
+  G4int m_iNbPassedScatter;
+  G4int m_iNbPassedFiducial;
+  G4int m_iNbPassedEnergy;
+
+  OutputMode m_iOutputMode;
+  G4int m_iHistogramEnergyBins;
+  G4double m_dHistogramEnergyMax;
+  TH1F *m_pEnergyHistogram;
+  TH1F *m_pClusterEnergyHistogram;
+  TH1F *m_pSingleScatterEnergyHistogram;
+  TH2F *m_pClusterXYHistogram;
+  TH2F *m_pClusterRZHistogram;
+
+  G4int m_iParquetBatchSize;
+
+  G4bool m_bAsyncWrite;
+  G4int m_iAsyncQueueSize;
+  HTPCAsyncQueue<std::function<void()> > *m_pWriterQueue;
+  HTPCEventData *m_pTreeEventData;        // bound to the branches
+  vector<HTPCEventData *> m_hFreeRecords;
+  std::mutex m_hRecordMutex;
+
+  G4int m_iCompressionSettings;           // -1: ROOT default
+  vector<std::pair<G4String, G4int> > m_hBasketSizes;
+  G4bool m_bAutoFlushSet;
+  G4int m_iAutoFlush;
+
+  vector<std::pair<G4String, G4bool> > m_hBranchRules;
+  struct StepSelection
+  {
+    G4bool bTrackId, bParentId, bType, bParentType, bCreatorProcess, bDepositingProcess;
+    G4bool bX, bY, bZ, bEnergyDeposited, bPreStepEnergy, bPostStepEnergy, bTime;
+  } m_hStepSelection;
+  size_t m_iMaxNbSteps;                   // largest event so far, to size new records
+  size_t m_iMaxNbClusters;
+#ifdef HTPC_WITH_ARROW
+  HTPCParquetWriter *m_pParquetWriter;
+#endif
 };
 
 #endif // __XENON10PANALYSISMANAGER_H__
@@ -0,0 +1,77 @@
+#ifndef __HTPCANALYSISMESSENGER_H__
+#define __HTPCANALYSISMESSENGER_H__
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class HTPCAnalysisManager;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+
+class HTPCAnalysisMessenger : public G4UImessenger
+{
+public:
+  HTPCAnalysisMessenger(HTPCAnalysisManager* pAnalysisManager);
+  ~HTPCAnalysisMessenger();
+
+public:
+  void SetNewValue(G4UIcommand*, G4String);
+
+private:
+  HTPCAnalysisManager* m_pAnalysisManager;
+
+private:
+  G4UIdirectory* m_pSignalDirectory;
+
+  G4UIcmdWithAString* m_pLightCollectionMapCmd;
+  G4UIcmdWithAString* m_pLightCollectionMapOutputCmd;
+
+  G4UIcmdWithABool* m_pSynthesisCmd;
+  G4UIcmdWithADouble* m_pG1Cmd;
+  G4UIcmdWithADouble* m_pSingleElectronGainCmd;
+  G4UIcmdWithADouble* m_pExtractionCmd;
+  G4UIcmdWithADouble* m_pDriftVelocityCmd;
+  G4UIcmdWithADoubleAndUnit* m_pElectronLifetimeCmd;
+  G4UIcommand* m_pRecombinationCmd;
+  G4UIcmdWithADoubleAndUnit* m_pClusterScaleCmd;
+  G4UIcmdWithADoubleAndUnit* m_pLiquidLevelCmd;
+
+  G4UIdirectory* m_pFilterDirectory;
+
+  G4UIcmdWithABool* m_pFilterCmd;
+  G4UIcmdWithAString* m_pScatterCmd;
+  G4UIcmdWithADoubleAndUnit* m_pScatterThresholdCmd;
+  G4UIcmdWithADoubleAndUnit* m_pFiducialRadiusCmd;
+  G4UIcommand* m_pFiducialZCmd;
+  G4UIcommand* m_pEnergyWindowCmd;
+
+  G4UIdirectory* m_pOutputDirectory;
+
+  G4UIcmdWithAString* m_pOutputModeCmd;
+  G4UIcommand* m_pEnergyBinningCmd;
+  G4UIcmdWithAnInteger* m_pParquetBatchSizeCmd;
+  G4UIcmdWithABool* m_pAsyncWriteCmd;
+  G4UIcmdWithAnInteger* m_pAsyncQueueSizeCmd;
+  G4UIcmdWithABool* m_pPrimaryTableCmd;
+  G4UIcommand* m_pCompressionCmd;
+  G4UIcommand* m_pBasketSizeCmd;
+  G4UIcmdWithAnInteger* m_pAutoFlushCmd;
+  G4UIcmdWithAString* m_pPresetCmd;
+  G4UIcmdWithAString* m_pKeepCmd;
+  G4UIcmdWithAString* m_pDropCmd;
+  G4UIcmdWithAString* m_pProfileCmd;
+
+  G4UIcmdWithABool* m_pWriteEmptyCmd;
+
+  G4UIdirectory* m_pPhaseSpaceDirectory;
+  G4UIcmdWithAString* m_pPhaseSpaceVolumeCmd;
+  G4UIcmdWithABool* m_pPhaseSpaceStopCmd;
+  G4UIcmdWithAString* m_pPhaseSpaceParticlesCmd;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef __HTPCASYNCQUEUE_H__
+#define __HTPCASYNCQUEUE_H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Bounded queue consumed by one worker thread, to move slow output (file
+// writes, compression) off the event loop. Push() blocks while iMaxSize
+// items are waiting, so memory stays bounded if the consumer falls behind.
+// Items are consumed in order. Close() waits until every pushed item has
+// been consumed; it is called by the destructor.
+template <typename T>
+class HTPCAsyncQueue {
+ public:
+  HTPCAsyncQueue(std::function<void(T &)> hConsumer, size_t iMaxSize = 4)
+      : m_hConsumer(hConsumer),
+        m_iMaxSize(iMaxSize ? iMaxSize : 1),
+        m_bClosed(false),
+        m_hWorker(&HTPCAsyncQueue::Run, this) {}
+
+  ~HTPCAsyncQueue() { Close(); }
+
+  HTPCAsyncQueue(const HTPCAsyncQueue &) = delete;
+  HTPCAsyncQueue &operator=(const HTPCAsyncQueue &) = delete;
+
+  void Push(T &&hItem) {
+    std::unique_lock<std::mutex> hLock(m_hMutex);
+    m_hNotFull.wait(hLock, [this]() { return m_hItems.size() < m_iMaxSize; });
+    m_hItems.push_back(std::move(hItem));
+    m_hNotEmpty.notify_one();
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> hLock(m_hMutex);
+      if (m_bClosed) return;
+      m_bClosed = true;
+    }
+    m_hNotEmpty.notify_one();
+    m_hWorker.join();
+  }
+
+ private:
+  void Run() {
+    for (;;) {
+      T hItem;
+      {
+        std::unique_lock<std::mutex> hLock(m_hMutex);
+        m_hNotEmpty.wait(hLock,
+                         [this]() { return m_bClosed || !m_hItems.empty(); });
+        if (m_hItems.empty()) return;
+        hItem = std::move(m_hItems.front());
+        m_hItems.pop_front();
+      }
+      m_hNotFull.notify_one();
+      m_hConsumer(hItem);
+    }
+  }
+
+  std::function<void(T &)> m_hConsumer;
+  size_t m_iMaxSize;
+  bool m_bClosed;
+  std::deque<T> m_hItems;
+  std::mutex m_hMutex;
+  std::condition_variable m_hNotEmpty;
+  std::condition_variable m_hNotFull;
+  std::thread m_hWorker;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __HTPCBINARYINPUT_H__
+#define __HTPCBINARYINPUT_H__
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Read-only memory mapping of a generator input file, usually a binary file
+// that starts with an 8 character magic, read sequentially through a cursor. The kernel
+// is told that the file is read sequentially and the pages ahead of the
+// cursor are requested in windows of iPrefetchSize bytes, so that reading
+// an event is a copy from memory. Independent of Geant4.
+//
+// Formats, all in the byte order of the machine that wrote them:
+//
+//   "HTPCMV01"  multivertex generator (htpcConvert multivertex), per event
+//               int32 event id, uint32 number of sites, then per site
+//               float x, y, z (mm), t (ns), photons, recoil type (0: ER,
+//               1: NR), S2 time width (ns, 0 for S1)
+//   "HTPCMU01"  muon flux (htpcConvert muon), fixed 36 byte records
+//               int32 event number, int32 type (10: mu+, 11: mu-), float
+//               energy (GeV), 3 unused floats, direction cosines cx, cy, cz
+//   "HTPCPS02"  phase space (HTPCPhaseSpaceWriter, phasespace generator),
+//               fixed 44 byte records and the exposure trailer, layout in
+//               HTPCPhaseSpaceWriter.hh
+class HTPCBinaryInput {
+ public:
+  static const size_t iMagicSize = 8;
+
+  HTPCBinaryInput();
+  ~HTPCBinaryInput();
+
+  HTPCBinaryInput(const HTPCBinaryInput &) = delete;
+  HTPCBinaryInput &operator=(const HTPCBinaryInput &) = delete;
+
+  // throws std::runtime_error if the file cannot be mapped or does not start
+  // with szMagic, files without magic (text) are opened with szMagic = 0
+  void Open(const std::string &hFilename, const char *szMagic,
+            size_t iPrefetchSize = 4 << 20);
+  void Close();
+  bool IsOpen() const { return m_pData != 0; }
+
+  // true if the file exists and starts with szMagic
+  static bool HasMagic(const std::string &hFilename, const char *szMagic);
+
+  // cursor in bytes from the start of the file, the first record is after
+  // the magic. Seeking forward inside the prefetched pages is free.
+  size_t GetPosition() const { return m_iPosition; }
+  size_t GetSize() const { return m_iSize; }
+  bool AtEnd() const { return m_iPosition >= m_iSize; }
+  void Seek(size_t iPosition);
+  void Rewind() { Seek(m_iStart); }
+
+  // whole file, for parsers working in place
+  const char *GetData() const { return m_pData; }
+
+  // copies iNbValues values at the cursor and advances it, throws
+  // std::runtime_error if the file ends before
+  template <typename T>
+  void Read(T *pValues, size_t iNbValues = 1) {
+    const size_t iNbBytes = iNbValues * sizeof(T);
+    if (m_iSize - m_iPosition < iNbBytes)
+      throw std::runtime_error("HTPCBinaryInput: " + m_hFilename +
+                               " is truncated");
+    std::memcpy(pValues, m_pData + m_iPosition, iNbBytes);
+    m_iPosition += iNbBytes;
+    if (m_iPosition + m_iPrefetchSize / 2 > m_iPrefetched &&
+        m_iPrefetched < m_iSize)
+      Prefetch();
+  }
+
+ private:
+  void Prefetch();
+
+  std::string m_hFilename;
+  const char *m_pData;
+  size_t m_iSize;
+  size_t m_iStart;
+  size_t m_iPosition;
+  size_t m_iPrefetchSize;
+  size_t m_iPrefetched;  // pages requested up to here
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef __HTPCBUFFEREDFILE_H__
+#define __HTPCBUFFEREDFILE_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary output file written through a buffer, for the side files of a run
+// (HTPCPrimaryTable, HTPCPhaseSpaceWriter). Independent of Geant4. Errors
+// throw std::runtime_error with the name of the owning class in front.
+class HTPCBufferedFile {
+ public:
+  explicit HTPCBufferedFile(const std::string &hOwner);
+  ~HTPCBufferedFile();
+
+  HTPCBufferedFile(const HTPCBufferedFile &) = delete;
+  HTPCBufferedFile &operator=(const HTPCBufferedFile &) = delete;
+
+  // truncates the file, bytes are collected in a buffer of iBufferSize bytes
+  // which is written when full
+  void Open(const std::string &hFilename, size_t iBufferSize);
+  bool IsOpen() const { return m_hFile.is_open(); }
+  const std::string &GetFilename() const { return m_hFilename; }
+
+  void Write(const void *pData, size_t iNbBytes);
+  void Close();
+
+ private:
+  void Flush();
+
+  std::string m_hOwner;
+  std::string m_hFilename;
+  std::ofstream m_hFile;
+  std::vector<char> m_hBuffer;
+  size_t m_iBufferSize;
+};
+
+#endif
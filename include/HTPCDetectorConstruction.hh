@@ -12,6 +12,7 @@ using std::map;
 
 class G4Sphere;
 class G4Colour;
+class G4Material;
 class G4LogicalVolume;
 class G4VPhysicalVolume;
 //class PurdueDetectorMessenger; ->To be updated still
@@ -41,14 +42,32 @@ public:
     void ConstructCryostats();
     void ConstructMedia();
     void ConstructTPC();
+    void DefineRegions();
     void ResetPMTCache();
 
+    G4Material *BuildPMTArrayMaterial(const G4String &hName,
+                                      G4Material *pMedium,
+                                      G4double dSlabVolume,
+                                      G4int iNbPMTs);
+    G4Material *BuildPerforatedPlateMaterial(const G4String &hName,
+                                             G4Material *pPlate,
+                                             G4Material *pMedium,
+                                             G4double dPlateVolume,
+                                             G4double dHolesVolume);
+    G4VPhysicalVolume *ConstructPMTArraySlab(const G4String &hName,
+                                             G4LogicalVolume *pMotherLogicalVolume,
+                                             G4double dOffsetZ,
+                                             G4double dPMTHeight,
+                                             G4int iNbPMTs,
+                                             G4int iCopyNo);
+
     void ConstructDetector();
 
     G4LogicalVolume *ConstructPMT();
 
-    G4double GetGeometryParameter(const char *szParameter);
-    G4ThreeVector GetPMTPosition(G4int iPMTnB, G4int i_nmbPMTS);
+    G4double GetGeometryParameter(const char *szParameter) const;
+    const vector<G4ThreeVector> &GetPMTPositions();
+    G4ThreeVector GetPMTPosition(G4int iPMTnB);
 
 
 private:
@@ -56,7 +75,15 @@ private:
     static map<G4String, G4double> m_hGeometryParameters;
     std::vector<G4ThreeVector> fCachedPMTPositions;
     G4bool fPMTCacheInitialized = false;
-    G4int fCachedPMTCount = -1;
+
+    // PMT array layout, see HTPCPMTPacking
+    G4String m_hPMTLayout;
+    G4String m_hPMTLayoutFile;
+    G4double m_dPMTPitch;
+    G4double m_dPMTFootprint;
+    G4double m_dPMTOuterDiameter; // outer ring of the PMT solid, overlap threshold
+    G4double m_dPMTArrayRadius;
+    G4int    m_iNbPMTsRequested;
 
     // ROOT Setup
     TFile      *_fGeom;
@@ -77,6 +104,11 @@ private:
 
     G4GenericMessenger *fMessengerAlpha;
 
+    // Geometry level of detail: "full" or "simplified"
+    G4String m_hGeometryDetailLevel;
+
+    G4GenericMessenger *fMessengerGeometry;
+
     // Laboratory
     G4LogicalVolume*   logic_Lab;
     G4VPhysicalVolume* phys_Lab;
@@ -7,6 +7,9 @@
 using std::string;
 using std::vector;
 
+// Event record written to the output. The vectors are members, bound to the
+// tree branches by address, and keep their capacity from event to event;
+// Reserve() presizes a new record from the largest event seen so far.
 class HTPCEventData
 {
 public:
@@ -15,28 +18,31 @@ public:
 
 public:
 	void Clear();
+	// exchanges the contents, the vectors stay at the same addresses
+	void Swap(HTPCEventData &hOther);
+	// capacity for iNbSteps steps and iNbClusters clusters
+	void Reserve(size_t iNbSteps, size_t iNbClusters);
 
 public:
 	int m_iEventId;				        // the event ID
 	int m_iNbPMTHits;		            // number of pmt hits
-	vector<int> *m_pPMTHits;		    // number of photon hits per pmt
+	vector<int> m_hPMTHits;		        // number of photon hits per pmt
     float m_fTotalEnergyDeposited;      // total energy deposited in the ScintSD
 	int m_iNbSteps;				        // number of energy depositing steps
-	vector<int> *m_pTrackId;		    // id of the particle
-	vector<int> *m_pParentId;		    // id of the parent particle
-	vector<string> *m_pParticleType;	// type of particle
-	vector<string> *m_pParentType;		// type of particle
-	vector<string> *m_pCreatorProcess;	// interaction
-	vector<string> *m_pDepositingProcess;	// energy depositing process
-	vector<float> *m_pX;			    // position of the step
-	vector<float> *m_pY;
-	vector<float> *m_pZ;
-	vector<float> *m_pEnergyDeposited; 	// energy deposited in the step
-	vector<float> *m_pKineticEnergy;	// track kinetic energy
-  	vector<float> *m_pPreStepEnergy;	// pre-step particle energy
-    vector<float> *m_pPostStepEnergy;	// post-step particle energy
-	vector<float> *m_pTime;			    // time of the step
-	vector<string> *m_pPrimaryParticleType;	// type of particle
+	vector<int> m_hTrackId;		        // id of the particle
+	vector<int> m_hParentId;		    // id of the parent particle
+	vector<string> m_hParticleType;	    // type of particle
+	vector<string> m_hParentType;		// type of particle
+	vector<string> m_hCreatorProcess;	// interaction
+	vector<string> m_hDepositingProcess;	// energy depositing process
+	vector<float> m_hX;			        // position of the step
+	vector<float> m_hY;
+	vector<float> m_hZ;
+	vector<float> m_hEnergyDeposited; 	// energy deposited in the step
+  	vector<float> m_hPreStepEnergy;	    // pre-step particle energy
+    vector<float> m_hPostStepEnergy;	// post-step particle energy
+	vector<float> m_hTime;			    // time of the step
+	vector<string> m_hPrimaryParticleType;	// type of particle
 	float m_fPrimaryX;			        // position of the primary particle
 	float m_fPrimaryY;
 	float m_fPrimaryZ;
@@ -48,6 +54,18 @@ public:
     float m_fPrimaryCz;
     float m_fPrimaryE;
     float m_fPrimaryW;
+	int m_iNbClusters;				    // number of interactions (signal stage)
+	vector<float> m_hClusterEnergy;	    // energy of the interaction
+	vector<float> m_hClusterX;		    // position of the interaction
+	vector<float> m_hClusterY;
+	vector<float> m_hClusterZ;
+	vector<int> m_hClusterNbPhotons;	// scintillation photons produced
+	vector<int> m_hClusterNbElectrons;	// ionisation electrons escaping recombination
+	vector<float> m_hClusterDriftTime;	// drift time to the liquid level
+	vector<float> m_hClusterS1;		    // S1 area (PE)
+	vector<float> m_hClusterS2;		    // S2 area (PE)
+	float m_fS1;					    // S1 and S2 areas summed over the interactions
+	float m_fS2;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef __HTPCGEOMETRYVALIDATOR_H__
+#define __HTPCGEOMETRYVALIDATOR_H__
+
+#include <globals.hh>
+#include <G4ThreeVector.hh>
+
+#include <map>
+#include <vector>
+
+using std::map;
+using std::vector;
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+class G4VSolid;
+
+// Overlap check and mass report for the whole geometry, used by
+// hermeticTPC --check-geometry.
+//
+// Surface points are sampled once per solid (serially, the random engine is
+// not thread safe) and the placements are then checked in parallel: every
+// point of a daughter is tested against its mother and against the sisters
+// whose bounding boxes intersect its own, so a mother with N daughters costs
+// O(N) rather than O(N^2).
+class HTPCGeometryValidator {
+ public:
+  HTPCGeometryValidator(G4int iResolution = 10000, G4int iNbThreads = 0,
+                        G4double dTolerance = 0.);
+  ~HTPCGeometryValidator();
+
+  // returns the number of overlapping pairs found
+  G4int CheckOverlaps(G4VPhysicalVolume *pWorld);
+  void PrintVolumeReport();
+
+ private:
+  struct Placement {
+    G4VPhysicalVolume *pVolume;
+    G4LogicalVolume *pMother;
+    G4ThreeVector hBoxMin;
+    G4ThreeVector hBoxMax;
+    vector<size_t> hCandidates;  // sisters with intersecting bounding boxes
+  };
+
+  struct Overlap {
+    size_t iPlacement;
+    G4int iOther;  // index of the sister, -1 for the mother
+    G4ThreeVector hPoint;
+    G4double dDepth;
+    G4int iNbPoints;
+  };
+
+  void CollectPlacements(G4LogicalVolume *pMother);
+  void CheckPlacement(size_t iPlacement, vector<Overlap> &hOverlaps) const;
+
+ private:
+  G4int m_iResolution;
+  G4int m_iNbThreads;
+  G4double m_dTolerance;
+
+  vector<G4LogicalVolume *> m_hMothers;
+  vector<Placement> m_hPlacements;
+  map<const G4VSolid *, vector<G4ThreeVector> > m_hSurfacePoints;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __HTPCLIGHTCOLLECTIONMAP_H__
+#define __HTPCLIGHTCOLLECTIONMAP_H__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Probability that a photon emitted in a voxel of a regular 3D grid is
+// detected by each PMT, independent of Geant4 so that maps can be inspected
+// and merged outside the simulation.
+//
+// Only the PMTs with a non-zero probability are stored for each voxel
+// (compressed sparse rows), as a binary file:
+//
+//   char     magic[8]           "HTPCLCE1"
+//   uint32   nx, ny, nz, npmts
+//   double   xmin, xmax, ymin, ymax, zmin, zmax   (mm)
+//   uint64   offsets[nx*ny*nz + 1]                first entry of each voxel
+//   uint16   pmt[offsets[nx*ny*nz]]
+//   float    probability[offsets[nx*ny*nz]]
+//
+// in the byte order of the machine that wrote it.
+class HTPCLightCollectionMap {
+ public:
+  HTPCLightCollectionMap();
+
+  // throws std::runtime_error if the file cannot be read or is malformed,
+  // e.g. if its size does not match the grid and entries of the header
+  void Load(const std::string &hFilename);
+  bool IsLoaded() const { return !m_hOffsets.empty(); }
+
+  // voxel index of a point in mm, -1 outside the grid
+  long FindVoxel(double x, double y, double z) const;
+
+  size_t GetNbPMTs() const { return m_iNbPMTs; }
+  size_t GetNbVoxels() const {
+    return static_cast<size_t>(m_iNbBins[0]) * m_iNbBins[1] * m_iNbBins[2];
+  }
+
+  // entries [GetFirstEntry(v), GetLastEntry(v)) belong to voxel v
+  size_t GetFirstEntry(long iVoxel) const { return m_hOffsets[iVoxel]; }
+  size_t GetLastEntry(long iVoxel) const { return m_hOffsets[iVoxel + 1]; }
+  unsigned GetPMT(size_t iEntry) const { return m_hPMTs[iEntry]; }
+  float GetProbability(size_t iEntry) const { return m_hProbabilities[iEntry]; }
+
+  // Building a map from an optical calibration run: Book() defines the grid,
+  // the emitted and detected photons are counted per voxel and Write()
+  // stores detected/emitted. Throws std::invalid_argument for an empty grid
+  // or more than 65535 PMTs.
+  void Book(const unsigned piNbBins[3], const double pdMin[3],
+            const double pdMax[3], unsigned iNbPMTs);
+  void AddEmitted(long iVoxel, uint64_t iNbPhotons);
+  void AddDetected(long iVoxel, unsigned iPMT, uint64_t iNbPhotons = 1);
+  // throws std::runtime_error if the file cannot be written
+  void Write(const std::string &hFilename) const;
+
+  // voxel centre in mm
+  void GetVoxelCenter(long iVoxel, double &x, double &y, double &z) const;
+
+ private:
+  uint32_t m_iNbBins[3];
+  uint32_t m_iNbPMTs;
+  double m_dMin[3];
+  double m_dMax[3];
+
+  std::vector<uint64_t> m_hOffsets;
+  std::vector<uint16_t> m_hPMTs;
+  std::vector<float> m_hProbabilities;
+
+  // photon counts while building
+  std::vector<uint64_t> m_hEmitted;
+  std::vector<std::map<uint16_t, uint64_t> > m_hDetected;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __HTPCPMTPACKING_H__
+#define __HTPCPMTPACKING_H__
+
+#include <string>
+#include <vector>
+
+// PMT array layouts in the plane of an array, independent of Geant4 so that
+// layouts can be generated and inspected outside the simulation.
+//
+// All lengths are in the caller's units. Positions are returned as one
+// contiguous array, ordered as they should be numbered (copy numbers).
+class HTPCPMTPacking {
+ public:
+  enum Layout { kHexagonal, kRings, kFile };
+
+  struct Position {
+    double x;
+    double y;
+  };
+
+  // distance between rows of a hexagonal grid with the given pitch
+  static constexpr double HexRowSpacing(double dPitch) {
+    return dPitch * 0.86602540378443864676;
+  }
+
+  // number of PMTs on ring iRing (>= 1) of a concentric layout
+  static constexpr int RingCount(int iRing) {
+    return static_cast<int>(6.28318530717958647692 * iRing);
+  }
+
+  // Hexagonal grid, rows along x, filled row by row from -y. A PMT is kept if
+  // its footprint (radius dPMTRadius) lies inside dOuterRadius. Stops after
+  // iMaxCount PMTs (0 = as many as fit). The grid is recentred on its centroid.
+  static std::vector<Position> Hexagonal(double dOuterRadius, double dPMTRadius,
+                                         double dPitch, int iMaxCount = 0);
+
+  // Central PMT plus concentric rings spaced by dPitch, RingCount(k) PMTs on
+  // ring k, odd rings rotated by half a step.
+  static std::vector<Position> Rings(double dOuterRadius, double dPMTRadius,
+                                     double dPitch, int iMaxCount = 0);
+
+  // One "x,y" (or "x y") pair per line, '#' starts a comment. Throws
+  // std::runtime_error if the file cannot be read or a line cannot be parsed.
+  static std::vector<Position> FromFile(const std::string &hFilename,
+                                        int iMaxCount = 0);
+
+  static std::vector<Position> Generate(Layout iLayout, double dOuterRadius,
+                                        double dPMTRadius, double dPitch,
+                                        int iMaxCount = 0,
+                                        const std::string &hFilename = "");
+
+  // "hex", "rings" or "file"; throws std::invalid_argument otherwise
+  static Layout ParseLayout(const std::string &hLayout);
+
+  // smallest centre-to-centre distance in the layout (0 for fewer than 2)
+  static double MinimumDistance(const std::vector<Position> &hPositions);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef __HTPCPARQUETWRITER_H__
+#define __HTPCPARQUETWRITER_H__
+
+#ifdef HTPC_WITH_ARROW
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HTPCAsyncQueue.hh"
+
+class HTPCEventData;
+
+namespace parquet {
+namespace arrow {
+class FileWriter;
+}
+}  // namespace parquet
+
+// Event output as two flat Parquet tables, <base>_steps.parquet with one row
+// per energy depositing step and <base>_primaries.parquet with one row per
+// event, both with an eventid column. Rows are buffered into record batches
+// of iBatchSize steps which are converted and written by a worker thread.
+//
+// Only built with -DWITH_ARROW=ON. Close() throws std::runtime_error if a
+// batch could not be written.
+class HTPCParquetWriter {
+ public:
+  HTPCParquetWriter(const std::string &hBasename, size_t iBatchSize = 100000);
+  ~HTPCParquetWriter();
+
+  void Fill(const HTPCEventData &hEventData);
+  void Close();
+
+ private:
+  struct Batch {
+    // steps
+    std::vector<int> hEventId;
+    std::vector<int> hTrackId;
+    std::vector<int> hParentId;
+    std::vector<std::string> hType;
+    std::vector<std::string> hParentType;
+    std::vector<std::string> hCreatorProcess;
+    std::vector<std::string> hDepositingProcess;
+    std::vector<float> hX, hY, hZ;
+    std::vector<float> hEnergyDeposited;
+    std::vector<float> hPreStepEnergy;
+    std::vector<float> hPostStepEnergy;
+    std::vector<float> hTime;
+
+    // primaries
+    std::vector<int> hPrimaryEventId;
+    std::vector<std::string> hPrimaryType;
+    std::vector<float> hPrimaryX, hPrimaryY, hPrimaryZ;
+    std::vector<float> hPrimaryCx, hPrimaryCy, hPrimaryCz;
+    std::vector<float> hPrimaryE;
+    std::vector<float> hPrimaryW;
+    std::vector<float> hTotalEnergy;
+    std::vector<int> hNbSteps;
+  };
+
+  void Write(Batch &hBatch);
+  void Flush();
+
+  size_t m_iBatchSize;
+  std::unique_ptr<Batch> m_pBatch;
+
+  std::unique_ptr<parquet::arrow::FileWriter> m_pStepsWriter;
+  std::unique_ptr<parquet::arrow::FileWriter> m_pPrimariesWriter;
+  std::string m_hError;
+
+  std::unique_ptr<HTPCAsyncQueue<std::unique_ptr<Batch> > > m_pQueue;
+};
+
+#endif
+
+#endif
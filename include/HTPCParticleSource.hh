@@ -7,6 +7,8 @@
 #include "generators/Xenon1tDecay0Generator.hh"
 #include "generators/Xenon1tMultiVertexGenerator.hh"
 #include "generators/Xenon1tAmBeGenerator.hh"
+#include "generators/HTPCLightMapGenerator.hh"
+#include "generators/HTPCPhaseSpaceGenerator.hh"
 
 #include "HTPCParticleSourceMessenger.hh"
 
@@ -37,6 +39,8 @@ class Xenon1tMuonGenerator;
 class Xenon1tDecay0Generator;
 class Xenon1tMultiVertexGenerator;
 class Xenon1tAmBeGenerator;
+class HTPCLightMapGenerator;
+class HTPCPhaseSpaceGenerator;
 
 class HTPCParticleSource : public G4VPrimaryGenerator
 {
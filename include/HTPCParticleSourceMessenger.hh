@@ -49,7 +49,15 @@ private:
 
   G4UIcmdWithAString *m_pMultiEventFromFileCmd;
   G4UIcmdWithAString *m_pDecay0EventFromFileCmd;
+  G4UIcmdWithAnInteger *m_pDecay0StartEventCmd;
   G4UIcmdWithAString *m_pMuonsFromFileCmd;
+  G4UIcmdWithAnInteger *m_pMuonStartRecordCmd;
+  G4UIcmdWithAString *m_pMuonSamplingCmd;
+  G4UIcmdWithAString *m_pMuonTargetCmd;
+  G4UIcommand *m_pMuonTargetCylinderCmd;
+  G4UIcmdWithAString *m_pPhaseSpaceFileCmd;
+  G4UIcmdWithABool *m_pPhaseSpaceRotateCmd;
+  G4UIcommand *m_pLightMapBinsCmd;
 
   G4UIcmdWithAString *m_pTypeCmd;
   G4UIcmdWithAString *m_pShapeCmd;
@@ -0,0 +1,79 @@
+#ifndef __HTPCPHASESPACEWRITER_H__
+#define __HTPCPHASESPACEWRITER_H__
+
+#include <cstdint>
+#include <string>
+
+#include "HTPCBufferedFile.hh"
+
+// Particles entering a volume, written in a first simulation stage so that a
+// second stage replays them (phasespace generator) without transporting the
+// expensive outer geometry again. Independent of Geant4, binary file:
+//
+//   char     magic[8]           "HTPCPS02"
+//   then fixed 44 byte records:
+//   int32    event id of the first stage
+//   int32    PDG code
+//   float    x, y, z (mm), cx, cy, cz, kinetic energy (keV), time (ns),
+//            weight
+//   and a 24 byte trailer, the exposure of the first stage:
+//   char     tag[8]             "HTPCPSEX"
+//   int64    number of first stage events, with or without particles
+//   double   sum of the weights of their primaries
+//
+// in the byte order of the machine that wrote it. The records of an event
+// are consecutive. The trailer is written by Close(), a file without it is
+// from a run that did not finish.
+class HTPCPhaseSpaceWriter {
+ public:
+  struct Record {
+    int32_t iEventId;
+    int32_t iPDGCode;
+    float fX, fY, fZ;
+    float fCx, fCy, fCz;
+    float fEnergy;
+    float fTime;
+    float fWeight;
+  };
+
+  struct Exposure {
+    char szTag[8];
+    int64_t iNbEvents;
+    double dWeight;
+  };
+
+  static const char szMagic[9];
+  static const char szExposureTag[9];
+
+  HTPCPhaseSpaceWriter();
+  ~HTPCPhaseSpaceWriter();
+
+  // Records are collected in a buffer of iBufferSize bytes which is written
+  // when full. Throws std::runtime_error if the file cannot be opened.
+  void Open(const std::string &hFilename, size_t iBufferSize = 1 << 20);
+  bool IsOpen() const { return m_hFile.IsOpen(); }
+
+  // throws std::runtime_error if the buffer cannot be written
+  void Fill(const Record &hRecord);
+  // counts a first stage event, also one without any record
+  void AddEvent(double dWeight);
+  // writes the exposure and closes the file
+  void Close();
+
+  size_t GetNbRecords() const { return m_iNbRecords; }
+  int64_t GetNbEvents() const { return m_iNbEvents; }
+  double GetTotalWeight() const { return m_dTotalWeight; }
+
+ private:
+  HTPCBufferedFile m_hFile;
+  size_t m_iNbRecords;
+  int64_t m_iNbEvents;
+  double m_dTotalWeight;
+};
+
+static_assert(sizeof(HTPCPhaseSpaceWriter::Record) == 44,
+              "phase space records are 44 bytes without padding");
+static_assert(sizeof(HTPCPhaseSpaceWriter::Exposure) == 24,
+              "the phase space trailer is 24 bytes without padding");
+
+#endif
@@ -7,12 +7,15 @@
 
 // Additional Header Files
 #include <globals.hh>
+#include <map>
 #include <vector>
 using namespace std;
 
 // G4 Header Files
 #include "G4VModularPhysicsList.hh"
 
+class HTPCPhysicsListMessenger;
+
 class HTPCPhysicsList : public G4VModularPhysicsList {
 public:
     HTPCPhysicsList();
@@ -26,8 +29,28 @@ public:
   void SetCerenkov(G4bool useCerenkov);
   void SetEMlowEnergyModel(G4String theModel);
   void SetHadronicModel(G4String theModel);
+  void SetOpticalPhysics(G4bool bEnable);
+  void SetEmExtraPhysics(G4bool bEnable);
+  void SetStoppingPhysics(G4bool bEnable);
+
+  // per-region production cuts ("all" sets gamma, e-, e+ and proton)
+  void SetRegionCut(const G4String &hRegion, const G4String &hParticle, G4double dCut);
+  void SetRegionEmModel(const G4String &hRegion, const G4String &hModel);
+
+  // physics table cache: tables are retrieved from <dir>/<key> if a complete
+  // set exists for the current configuration, otherwise they are stored there
+  // by StorePhysicsTableCache() once they have been built
+  void SetPhysicsTableCache(const G4String &hDirectory);
+  void StorePhysicsTableCache();
+
+ private:
+  void ApplyRegionCuts();
+  void RemovePhysicsOfType(G4int iType);
+  G4String GetTableCacheConfiguration() const;
 
  private:
+  HTPCPhysicsListMessenger *m_pMessenger;
+
   G4VPhysicsConstructor *OpticalPhysicsModel;
 
   G4int VerboseLevel;
@@ -36,5 +59,11 @@ public:
   G4String m_hEMlowEnergyModel;
   G4String m_hHadronicModel;
   G4bool m_bCerenkov;
+
+  map<G4String, map<G4String, G4double> > m_hRegionCuts;
+
+  G4String m_hTableCacheDirectory;
+  G4String m_hTableCacheKey;
+  G4bool m_bStoreTableCache;
 };
 #endif
\ No newline at end of file
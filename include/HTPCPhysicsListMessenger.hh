@@ -0,0 +1,40 @@
+#ifndef __HTPCPHYSICSLISTMESSENGER_H__
+#define __HTPCPHYSICSLISTMESSENGER_H__
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class HTPCPhysicsList;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIdirectory;
+
+class HTPCPhysicsListMessenger : public G4UImessenger
+{
+public:
+  HTPCPhysicsListMessenger(HTPCPhysicsList* pPhysicsList);
+  ~HTPCPhysicsListMessenger();
+
+public:
+  void SetNewValue(G4UIcommand*, G4String);
+
+private:
+  HTPCPhysicsList* m_pPhysicsList;
+
+private:
+  G4UIdirectory* m_pDirectory;
+
+  G4UIcommand* m_pRegionCutCmd;
+  G4UIcommand* m_pRegionEmModelCmd;
+  G4UIcmdWithAString* m_pTableCacheCmd;
+
+  G4UIcmdWithAString* m_pEmModelCmd;
+  G4UIcmdWithAString* m_pHadronicModelCmd;
+  G4UIcmdWithABool* m_pOpticalCmd;
+  G4UIcmdWithABool* m_pCerenkovCmd;
+  G4UIcmdWithABool* m_pEmExtraCmd;
+  G4UIcmdWithABool* m_pStoppingCmd;
+};
+
+#endif
@@ -35,6 +35,7 @@ class HTPCPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction {
     return m_hForcedPositionOfPrimary;
   }
   G4ThreeVector GetDirectionOfPrimary() { return m_hDirectionOfPrimary; }
+  HTPCParticleSource *GetParticleSource() { return m_pParticleSource; }
 
   G4double ComputeForcedTransportWeight(G4ThreeVector x0, G4ThreeVector dir,
                                         G4double L, G4double e);
@@ -0,0 +1,56 @@
+#ifndef __HTPCPRIMARYTABLE_H__
+#define __HTPCPRIMARYTABLE_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "HTPCBufferedFile.hh"
+
+// Primary particles of every simulated event, written next to the event output
+// so that runs which drop empty or filtered events can still be normalised
+// and their source distribution checked. Independent of Geant4, binary file:
+//
+//   char     magic[8]           "HTPCPV01"
+//   then one record per primary particle until the end of the file:
+//   varint   event id - previous event id   (LEB128, previous is -1 before
+//                                             the first record)
+//   float    x, y, z (mm), cx, cy, cz, energy (keV), weight
+//
+// in the byte order of the machine that wrote it. The event ids of a file
+// are non-decreasing, the primaries of one event follow each other with a
+// delta of 0. A record usually takes 33 bytes.
+class HTPCPrimaryTable {
+ public:
+  struct Record {
+    int64_t iEventId;
+    float fX, fY, fZ;
+    float fCx, fCy, fCz;
+    float fEnergy;
+    float fWeight;
+  };
+
+  HTPCPrimaryTable();
+
+  // Records are collected in a buffer of iBufferSize bytes which is written
+  // when full. Throws std::runtime_error if the file cannot be opened.
+  void Open(const std::string &hFilename, size_t iBufferSize = 1 << 20);
+  bool IsOpen() const { return m_hFile.IsOpen(); }
+
+  // throws std::invalid_argument if the event id decreases and
+  // std::runtime_error if the buffer cannot be written
+  void Fill(const Record &hRecord);
+  void Close();
+
+  size_t GetNbRecords() const { return m_iNbRecords; }
+
+  // throws std::runtime_error if the file cannot be read or is malformed
+  static void Read(const std::string &hFilename, std::vector<Record> &hRecords);
+
+ private:
+  HTPCBufferedFile m_hFile;
+  int64_t m_iPreviousEventId;
+  size_t m_iNbRecords;
+};
+
+#endif
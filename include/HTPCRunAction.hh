@@ -6,10 +6,12 @@
 class G4Run;
 
 class HTPCAnalysisManager;
+class HTPCPhysicsList;
 
 class HTPCRunAction : public G4UserRunAction {
  public:
-  HTPCRunAction(HTPCAnalysisManager *pAnalysisManager = 0);
+  HTPCRunAction(HTPCAnalysisManager *pAnalysisManager = 0,
+                HTPCPhysicsList *pPhysicsList = 0);
   ~HTPCRunAction();
 
  public:
@@ -22,6 +24,7 @@ class HTPCRunAction : public G4UserRunAction {
   G4int m_hRanSeed;
   //        G4bool m_hForcedTransport;
   HTPCAnalysisManager *m_pAnalysisManager;
+  HTPCPhysicsList *m_pPhysicsList;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef __HTPCSIGNALSYNTHESIS_H__
+#define __HTPCSIGNALSYNTHESIS_H__
+
+#include <globals.hh>
+#include <G4ThreeVector.hh>
+
+#include <vector>
+
+using std::vector;
+
+// S1/S2 areas of the interactions of an event, computed from the energy
+// deposits in the active liquid xenon.
+//
+// The deposits are clustered as in analysis/proc_root_reduced.py: following
+// the order of the hits, a deposit joins the current cluster if it is closer
+// than the cluster scale to the previous deposit. Each cluster is converted
+// into quanta (W = 13.7 eV, Lindhard quenching for nuclear recoils), split
+// into excitons and ions, and the recombining ions add to the photons. S1 is
+// the number of photons detected (g1); the electrons drift to the liquid
+// level, are attenuated by the electron lifetime, extracted into the gas and
+// give S2 through the single electron gain. Areas are in photoelectrons.
+class HTPCSignalSynthesis
+{
+public:
+  struct Deposit
+  {
+    G4ThreeVector hPosition;
+    G4double dEnergy;
+    G4bool bNuclearRecoil;
+  };
+
+  struct Cluster
+  {
+    G4ThreeVector hPosition;        // unweighted mean of the deposits
+    G4double dEnergy;
+    G4double dNuclearRecoilEnergy;  // part of dEnergy from nuclear recoils
+    G4int iNbPhotons;
+    G4int iNbElectrons;
+    G4double dDriftTime;
+    G4double dS1;
+    G4double dS2;
+  };
+
+public:
+  HTPCSignalSynthesis();
+
+  void SetG1(G4double dG1) { m_dG1 = dG1; }
+  void SetSingleElectronGain(G4double dGain) { m_dSingleElectronGain = dGain; }
+  void SetExtractionEfficiency(G4double dEfficiency) { m_dExtractionEfficiency = dEfficiency; }
+  void SetDriftVelocity(G4double dVelocity) { m_dDriftVelocity = dVelocity; }
+  void SetElectronLifetime(G4double dLifetime) { m_dElectronLifetime = dLifetime; }
+  void SetRecombination(G4double dElectronRecoil, G4double dNuclearRecoil)
+    { m_dRecombinationER = dElectronRecoil; m_dRecombinationNR = dNuclearRecoil; }
+  void SetClusterScale(G4double dScale) { m_dClusterScale = dScale; }
+  void SetLiquidLevel(G4double dZ) { m_dLiquidLevel = dZ; }
+
+  G4double GetLiquidLevel() const { return m_dLiquidLevel; }
+
+  // clusters of the deposits (energy > 0 only), in the order of the deposits
+  void Process(const vector<Deposit> &hDeposits, vector<Cluster> &hClusters) const;
+
+  // mean number of photons of a deposit, excitons and recombined ions, the
+  // expectation of the quanta sampled for the clusters
+  G4double GetMeanNbPhotons(G4double dEnergy, G4bool bNuclearRecoil) const;
+
+  // fraction of the recoil energy going into quanta (Lindhard, k = 0.166)
+  static G4double LindhardFactor(G4double dEnergy);
+
+private:
+  void SampleQuanta(G4double dEnergy, G4double dExcitonRatio, G4double dRecombination,
+                    G4int &iNbPhotons, G4int &iNbElectrons) const;
+
+private:
+  G4double m_dG1;
+  G4double m_dSingleElectronGain;
+  G4double m_dExtractionEfficiency;
+  G4double m_dDriftVelocity;
+  G4double m_dElectronLifetime;
+  G4double m_dRecombinationER;
+  G4double m_dRecombinationNR;
+  G4double m_dClusterScale;
+  G4double m_dLiquidLevel;
+};
+
+#endif
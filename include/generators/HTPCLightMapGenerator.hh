@@ -0,0 +1,42 @@
+#ifndef __HTPCLIGHTMAPGENERATOR__
+#define __HTPCLIGHTMAPGENERATOR__
+
+#include "Xenon1tGenericGenerator.hh"
+
+// Include Geant4 headers
+#include <globals.hh>
+#include <G4ThreeVector.hh>
+#include <G4ios.hh>
+
+// Optical calibration source for the light collection map: every event
+// emits /xe/gun/numberofparticles optical photons isotropically from the
+// centre of one voxel of a regular grid spanning the box /xe/gun/center
+// +- (halfx, halfy, halfz), /xe/gun/lightmapbins bins per axis. Voxels are
+// visited in turn (x fastest), those whose centre is outside the /xe/gun/confine
+// volumes are skipped.
+class HTPCLightMapGenerator : public Xenon1tGenericGenerator
+{
+public:
+  HTPCLightMapGenerator();
+  ~HTPCLightMapGenerator();
+public:
+  void GeneratePrimaryVertex(G4Event *pEvent);
+
+  void SetNbBins(G4int iNbBinsX, G4int iNbBinsY, G4int iNbBinsZ);
+  const G4int *GetNbBins() const { return m_iNbBins; }
+  G4ThreeVector GetGridMin() const;
+  G4ThreeVector GetGridMax() const;
+
+  // voxel of the last event and number of photons it emitted
+  long GetCurrentVoxel() const { return m_iCurrentVoxel; }
+  G4int GetNbPhotonsOfCurrentVoxel() const { return param->m_iNumberOfParticlesToBeGenerated; }
+
+private:
+  G4ThreeVector GetVoxelCenter(long iVoxel) const;
+
+private:
+  G4int m_iNbBins[3];
+  long m_iNextVoxel;
+  long m_iCurrentVoxel;
+};
+#endif
@@ -0,0 +1,55 @@
+#ifndef __HTPCPHASESPACEGENERATOR__
+#define __HTPCPHASESPACEGENERATOR__
+
+#include "Xenon1tGenericGenerator.hh"
+#include "HTPCBinaryInput.hh"
+#include "HTPCPhaseSpaceWriter.hh"
+
+// Include Geant4 headers
+#include <globals.hh>
+#include <G4ThreeVector.hh>
+#include <G4ios.hh>
+
+// Second stage of a two-stage simulation: replays the particles of a phase
+// space file (/htpc/phasespace/, HTPCPhaseSpaceWriter) given with
+// /xe/gun/phasespacefile. The particles of one first stage event form one
+// event, each with its own vertex, time and weight. The file is read again
+// from the start when all events are used, every pass is the exposure of
+// the first stage stored in the trailer of the file (number of events and
+// weight of their primaries), printed when the file is opened and at every
+// pass. With /xe/gun/phasespacerotate every event is rotated by a
+// random angle around the z axis, so that the passes over the file differ
+// for geometries symmetric around it.
+class HTPCPhaseSpaceGenerator : public Xenon1tGenericGenerator
+{
+public:
+  HTPCPhaseSpaceGenerator();
+  ~HTPCPhaseSpaceGenerator();
+public:
+  void GeneratePrimaryVertex(G4Event *pEvent);
+
+  void SetRotation(G4bool bRotate) { m_bRotate = bRotate; }
+
+  // exposure of one pass over the file, from its trailer
+  G4long GetNbFirstStageEvents() const { return m_iNbFirstStageEvents; }
+  G4double GetFirstStageWeight() const { return m_dFirstStageWeight; }
+  G4int GetNbPasses() const { return m_iNbPasses; }
+
+private:
+  void OpenPhaseSpaceFile();
+  // next record, returns true if the file started again
+  G4bool ReadRecord();
+  void AddVertex(G4Event *pEvent, const HTPCPhaseSpaceWriter::Record &hRecord);
+
+private:
+  HTPCBinaryInput m_hBinaryInput;
+  G4long m_iNbRecords;
+  size_t m_iDataEnd;                        // end of the records
+  G4long m_iNbFirstStageEvents;
+  G4double m_dFirstStageWeight;
+  G4int m_iNbPasses;
+  G4bool m_bRotate;
+  G4double m_dAngle;                        // rotation of the current event
+  HTPCPhaseSpaceWriter::Record m_hRecord;   // first record of the next event
+};
+#endif
@@ -12,8 +12,9 @@
 #include <G4ios.hh>
 
 #include "Xenon1tGenericGenerator.hh"
+#include "HTPCBinaryInput.hh"
 
-#include <fstream>
+#include <vector>
 
 class Xenon1tDecay0Generator : public Xenon1tGenericGenerator
 {
@@ -26,10 +27,18 @@ public:
   G4double GetTotalEnergyDecay0();
   void GeneratePrimaryVertex(G4Event *pEvent);
 
+  // first event of the file to simulate (/xe/gun/decay0startevent), so that
+  // array jobs read disjoint events. The file wraps around at its end.
+  void SetStartEvent(G4long iEvent);
+
 private:
+  void OpenDecay0File();
+
   G4bool stats;
-  std::ifstream raw;
-  G4String linebuffer;
+  HTPCBinaryInput m_hInput;               // mapped DECAY0 file
+  std::vector<size_t> m_hEventOffsets;    // start of each event in the file
+  size_t m_iNextEvent;
+  G4long m_iStartEvent;
 
   vector<G4ParticleMomentum>	*m_hParticleMomentum;
   vector<int> *m_hNumberOfProducedParticles;
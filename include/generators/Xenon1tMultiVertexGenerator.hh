@@ -12,6 +12,7 @@
 #include <G4ios.hh>
 
 #include "Xenon1tGenericGenerator.hh"
+#include "HTPCBinaryInput.hh"
 
 #include <fstream>
 
@@ -25,6 +26,7 @@ public:
   void GeneratePrimaryVertex(G4Event *pEvent);
 private:
   std::fstream infile;
+  HTPCBinaryInput m_hBinaryInput;   // HTPCMV01 files (htpcConvert multivertex)
 
   G4int m_iNumberOfInteractionSites;
   vector<G4ThreeVector> *m_hInteractionVertexPosition;
@@ -36,6 +38,8 @@ private:
   vector<int> *m_hRecoil_type;
 
 private:
+  void ReadEventFromBinaryFile();
+  void AddInteractionSite(const G4float ev[7]);
   G4double GetPhotonTime(Int_t Recoil_type);
 };
 #endif
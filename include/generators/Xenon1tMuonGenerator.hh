@@ -12,6 +12,7 @@
 #include <G4ios.hh>
 
 #include "Xenon1tGenericGenerator.hh"
+#include "HTPCBinaryInput.hh"
 
 #include <fstream>
 
@@ -24,8 +25,42 @@ public:
   G4String m_MuonType;
   void ReadEventFromMuonFile();
   void GeneratePrimaryVertex(G4Event *pEvent);
+
+  // first record of a binary muon file (/xe/gun/muonstartrecord), by default
+  // a random one. The records are then read in order and wrap around.
+  void SetStartRecord(G4long iRecord) { m_iStartRecord = iRecord; }
+
+  // impact points on the disk of radius Rmax orthogonal to the muon
+  // direction (/xe/gun/muonsampling disk), or only on the part of the disk
+  // whose muons cross a vertical cylinder around the target volume
+  // (/xe/gun/muonsampling target). The vertex weight of a target muon is its
+  // geometric acceptance, the projected area of the cylinder over the area
+  // of the disk, so that the sum of the weights counts the muons the disk
+  // sampling would have generated for the same flux.
+  void SetSamplingMode(const G4String &hMode) { m_hSamplingMode = hMode; m_bGeometryFound = false; }
+  // bounding cylinder of a physical volume, by default phys_oCryostat
+  void SetTargetVolume(const G4String &hVolumeName) { m_hTargetVolumeName = hVolumeName; m_bTargetCylinder = false; m_bGeometryFound = false; }
+  // explicit target cylinder, overrides the volume
+  void SetTargetCylinder(G4double dRadius, G4double dHalfZ, G4double dCenterZ);
 private:
+  void ReadRecord(G4int evi[2], G4float ev[7]);
+  void FindWorldAndTarget();
+  G4ThreeVector FindTargetDiskPos(G4ThreeVector, G4ThreeVector, G4ThreeVector);
+
   std::fstream infile;
+  HTPCBinaryInput m_hBinaryInput;   // HTPCMU01 files (htpcConvert muon)
+  G4long m_iNbRecords;
+  G4long m_iStartRecord;
+  G4String m_hSamplingMode;
+  G4String m_hTargetVolumeName;
+  G4bool m_bGeometryFound;
+  G4bool m_bTargetCylinder;
+  G4double m_dTargetRadius;
+  G4double m_dTargetHalfZ;
+  G4ThreeVector m_hTargetCenter;
+  G4ThreeVector m_hWorldMin;
+  G4ThreeVector m_hWorldMax;
+  G4double m_dWeight;
   G4ThreeVector FindDiskPos(G4ThreeVector, G4ThreeVector, G4double);
   G4ThreeVector FindInitPos(G4ThreeVector, G4ThreeVector);
 };
@@ -15,6 +15,10 @@ source /cvmfs/sft.cern.ch/lcg/views/LCG_105/x86_64-el9-gcc12-opt/setup.sh
 if [ "{{STEP}}" != "post" ]; then
     echo "Running GEANT4 simulation..."    
     cd /srv01/xenon/{{USER}}/HermeticTPC
+    # position of the job in the array, macros can use them to pick their
+    # share of a shared input file (/control/getEnv HTPC_JOB_INDEX)
+    export HTPC_JOB_INDEX={{JOBINDEX}}
+    export HTPC_NEVENTS={{NEVENTS}}
     ./build/bin/hermeticTPC -f macros/{{MACROFILE}} -n {{NEVENTS}} -o /storage/xenon/{{USER}}/hermeticTPC/{{OUTFILE}}
 
 fi
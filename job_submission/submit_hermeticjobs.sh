@@ -153,6 +153,7 @@ build_jobscript() {
     local macro="$5"
     local scale="$6"
     local step="$7"
+    local jobindex="$8"
 
     sed \
         -e "s|{{NEVENTS}}|$nevents|g" \
@@ -160,6 +161,7 @@ build_jobscript() {
         -e "s|{{BASENAME}}|$basename|g" \
         -e "s|{{MACROFILE}}|$macro|g" \
         -e "s|{{STEP}}|$step|g" \
+        -e "s|{{JOBINDEX}}|$jobindex|g" \
         -e "s|{{SCALE}}|$scale|g" \
         -e "s|{{USER}}|$USER|g" \
         "$TEMPLATE" > "$jobscript"
@@ -207,7 +209,7 @@ for ((i = START_INDEX; i <= END_INDEX; i++)); do
     fi
 
     JOBSCRIPT="$TMPDIR/hermeticsub_${JOBID}.sh"
-    build_jobscript "$JOBSCRIPT" "$NEVENTS" "$OUTFILE" "$BASENAME" "$MACROFILE" "$SCALE" "$STEP"
+    build_jobscript "$JOBSCRIPT" "$NEVENTS" "$OUTFILE" "$BASENAME" "$MACROFILE" "$SCALE" "$STEP" "$i"
     submit_job "$JOBSCRIPT" "$BASENAME" "$STEP"
 done
 
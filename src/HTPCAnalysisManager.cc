@@ -2,16 +2,29 @@
 #include <G4SDManager.hh>
 #include <G4Run.hh>
 #include <G4Event.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4Step.hh>
+#include <G4VTouchable.hh>
 #include <G4HCofThisEvent.hh>
 #include <G4EmCalculator.hh>
 #include <G4Material.hh>
 #include <G4HadronicProcessStore.hh>
 #include <G4ParticleTable.hh>
+#include <G4ParticleDefinition.hh>
 #include <G4NistManager.hh>
 #include <G4ElementTable.hh>
 #include <G4Version.hh>
 #include <G4SystemOfUnits.hh>
+#include <G4Poisson.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4RunManager.hh>
+#include <algorithm>
+#include <cfloat>
+#include <fnmatch.h>
 #include <numeric>
+#include <sstream>
+#include <stdexcept>
 
 #include <TROOT.h>
 #include <TFile.h>
@@ -19,42 +32,344 @@
 #include <TParameter.h>
 #include <TDirectory.h>
 #include <TH1.h>
+#include <TH2.h>
+#include <Compression.h>
 
 #include "HTPCDetectorConstruction.hh"
 #include "HTPCDetectorHit.hh"
 #include "HTPCPrimaryGeneratorAction.hh"
 #include "HTPCEventData.hh"
+#include "HTPCLightCollectionMap.hh"
+#include "HTPCParticleSource.hh"
+#include "HTPCParquetWriter.hh"
+#include "HTPCPhaseSpaceWriter.hh"
+#include "HTPCPrimaryTable.hh"
 
 #include "HTPCAnalysisManager.hh"
+#include "HTPCAnalysisMessenger.hh"
 
 HTPCAnalysisManager::HTPCAnalysisManager(HTPCPrimaryGeneratorAction *pPrimaryGeneratorAction) :
   m_iDetectorHitsCollectionID(-1), m_hDataFilename("events.root"), m_iNbEventsToSimulate(0),
   m_pTreeFile(0), m_pTree(0), _events(0),
   m_pNbEventsToSimulateParameter(0), m_pPrimaryGeneratorAction(pPrimaryGeneratorAction),
   m_pEventData(0), plotPhysics(true), runTime(0),
-  writeEmptyEvents(true)
+  writeEmptyEvents(true), m_iNbEmptyEvents(0),
+  m_bPrimaryTable(false), m_pPrimaryTable(0), m_bPhaseSpaceStop(true),
+  m_hPhaseSpaceParticleNames("neutron gamma"), m_pPhaseSpaceVolume(0),
+  m_pPhaseSpaceWriter(0), m_pLightCollectionMap(0),
+  m_pLightMapCalibration(0), m_pPMTWindow(0), m_bSignalSynthesis(false), m_bLiquidLevelSet(false),
+  m_bFilter(false), m_iScatterSelection(kAnyScatter), m_dScatterThreshold(1.*keV),
+  m_dFiducialRadius(DBL_MAX), m_dFiducialZMin(-DBL_MAX), m_dFiducialZMax(DBL_MAX),
+  m_dEnergyMin(0.), m_dEnergyMax(DBL_MAX), m_iNbFilteredEvents(0), m_iNbPassedScatter(0),
+  m_iNbPassedFiducial(0), m_iNbPassedEnergy(0), m_iOutputMode(kTree),
+  m_iHistogramEnergyBins(3000), m_dHistogramEnergyMax(3000.*keV), m_pEnergyHistogram(0),
+  m_pClusterEnergyHistogram(0), m_pSingleScatterEnergyHistogram(0), m_pClusterXYHistogram(0),
+  m_pClusterRZHistogram(0), m_iParquetBatchSize(100000), m_bAsyncWrite(false),
+  m_iAsyncQueueSize(64), m_pWriterQueue(0), m_pTreeEventData(0), m_iCompressionSettings(-1),
+  m_bAutoFlushSet(false), m_iAutoFlush(0), m_iMaxNbSteps(0), m_iMaxNbClusters(0)
+#ifdef HTPC_WITH_ARROW
+  , m_pParquetWriter(0)
+#endif
 
 {
   runTime = new G4Timer();
   m_pEventData = new HTPCEventData();
+  m_pSignalSynthesis = new HTPCSignalSynthesis();
+  m_pMessenger = new HTPCAnalysisMessenger(this);
 }
 
 HTPCAnalysisManager::~HTPCAnalysisManager()
-{}
+{
+  delete m_pMessenger;
+  delete m_pLightCollectionMap;
+  delete m_pLightMapCalibration;
+  delete m_pSignalSynthesis;
+  delete m_pWriterQueue;
+  FreeRecords();
+  delete m_pPrimaryTable;
+  delete m_pPhaseSpaceWriter;
+#ifdef HTPC_WITH_ARROW
+  delete m_pParquetWriter;
+#endif
+}
+
+void
+HTPCAnalysisManager::SetLightCollectionMap(const G4String &hFilename)
+{
+  HTPCLightCollectionMap *pMap = new HTPCLightCollectionMap();
+  try {
+    pMap->Load(hFilename);
+  } catch (const std::exception &hError) {
+    delete pMap;
+    G4Exception("HTPCAnalysisManager::SetLightCollectionMap()",
+                "Analysis001", FatalException, hError.what());
+    return;
+  }
+
+  delete m_pLightCollectionMap;
+  m_pLightCollectionMap = pMap;
+
+  G4cout << "HTPCAnalysisManager:: light collection map " << hFilename << ": "
+         << pMap->GetNbVoxels() << " voxels, " << pMap->GetNbPMTs() << " PMTs"
+         << G4endl;
+}
+
+void
+HTPCAnalysisManager::SetCompression(const G4String &hAlgorithm, G4int iLevel)
+{
+  if(hAlgorithm == "none")
+    m_iCompressionSettings = 0;
+  else if(hAlgorithm == "zlib")
+    m_iCompressionSettings = ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kZLIB, iLevel);
+  else if(hAlgorithm == "lzma")
+    m_iCompressionSettings = ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kLZMA, iLevel);
+  else if(hAlgorithm == "lz4")
+    m_iCompressionSettings = ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kLZ4, iLevel);
+  else if(hAlgorithm == "zstd")
+    m_iCompressionSettings = ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kZSTD, iLevel);
+  else
+    G4Exception("HTPCAnalysisManager::SetCompression()", "Analysis007", FatalErrorInArgument,
+                ("unknown compression algorithm " + hAlgorithm).c_str());
+}
+
+void
+HTPCAnalysisManager::SetOutputPreset(const G4String &hPreset)
+{
+  m_hBasketSizes.clear();
+
+  if(hPreset == "fastWrite")
+    {
+      // cheap compression, few large baskets, flush rarely
+      SetCompression("lz4", 1);
+      AddBasketSize("*", 256000);
+      SetAutoFlush(-50000000);
+    }
+  else if(hPreset == "smallArchive")
+    {
+      // strong compression over large clusters of entries
+      SetCompression("lzma", 8);
+      AddBasketSize("*", 512000);
+      SetAutoFlush(-100000000);
+    }
+  else
+    {
+      // ROOT defaults
+      m_iCompressionSettings = -1;
+      m_bAutoFlushSet = false;
+    }
+}
+
+void
+HTPCAnalysisManager::SetBranchProfile(const G4String &hProfile)
+{
+  m_hBranchRules.clear();
+  if(hProfile == "full")
+    return;
+
+  DropBranches("*");
+  if(hProfile == "minimal")
+    {
+      const char *szBranches[] = {"eventid", "etot", "nsteps", "xp", "yp", "zp", "ed",
+                                  "type_pri", "xp_pri", "yp_pri", "zp_pri", "e_pri", "w_pri"};
+      for(size_t i = 0; i < sizeof(szBranches)/sizeof(szBranches[0]); i++)
+        KeepBranches(szBranches[i]);
+    }
+  else if(hProfile == "signal")
+    {
+      const char *szBranches[] = {"eventid", "etot", "ncl", "cl_*", "s1", "s2",
+                                  "type_pri", "xp_pri", "yp_pri", "zp_pri", "e_pri", "w_pri"};
+      for(size_t i = 0; i < sizeof(szBranches)/sizeof(szBranches[0]); i++)
+        KeepBranches(szBranches[i]);
+    }
+  else
+    G4Exception("HTPCAnalysisManager::SetBranchProfile()", "Analysis008", FatalErrorInArgument,
+                ("unknown branch profile " + hProfile).c_str());
+}
+
+G4bool
+HTPCAnalysisManager::IsBranchSelected(const char *szBranch) const
+{
+  // the last matching rule decides, everything is kept by default
+  G4bool bKeep = true;
+  for(size_t i = 0; i < m_hBranchRules.size(); i++)
+    if(!fnmatch(m_hBranchRules[i].first.c_str(), szBranch, 0))
+      bKeep = m_hBranchRules[i].second;
+
+  return bKeep;
+}
+
+void
+HTPCAnalysisManager::SelectStepQuantities()
+{
+  // the other outputs need every quantity of the steps
+  G4bool bAll = (m_iOutputMode != kTree);
+
+  m_hStepSelection.bTrackId = bAll || IsBranchSelected("trackid");
+  m_hStepSelection.bParentId = bAll || IsBranchSelected("parentid");
+  m_hStepSelection.bType = bAll || IsBranchSelected("type");
+  m_hStepSelection.bParentType = bAll || IsBranchSelected("parenttype");
+  m_hStepSelection.bCreatorProcess = bAll || IsBranchSelected("creaproc");
+  m_hStepSelection.bDepositingProcess = bAll || IsBranchSelected("edproc");
+  m_hStepSelection.bX = bAll || IsBranchSelected("xp");
+  m_hStepSelection.bY = bAll || IsBranchSelected("yp");
+  m_hStepSelection.bZ = bAll || IsBranchSelected("zp");
+  m_hStepSelection.bEnergyDeposited = bAll || IsBranchSelected("ed");
+  m_hStepSelection.bPreStepEnergy = bAll || IsBranchSelected("PreStepEnergy");
+  m_hStepSelection.bPostStepEnergy = bAll || IsBranchSelected("PostStepEnergy");
+  m_hStepSelection.bTime = bAll || IsBranchSelected("time");
+}
 
 void
 HTPCAnalysisManager::BeginOfRun(const G4Run *)
 {
   // start a timer for this run....
   runTime->Start();
-  // do we write empty events or not?
-  writeEmptyEvents = m_pPrimaryGeneratorAction->GetWriteEmpty();
+  m_iNbEmptyEvents = 0;
+
+  // optical calibration run, book the light collection map
+  delete m_pLightMapCalibration;
+  m_pLightMapCalibration = 0;
+  m_pPMTWindow = 0;
+  HTPCParticleSource *pParticleSource = m_pPrimaryGeneratorAction->GetParticleSource();
+  if(pParticleSource->GetCurrentGeneratorType() == "lightmap")
+    {
+      m_pPMTWindow = G4PhysicalVolumeStore::GetInstance()->GetVolume("Quartz_PMTWindow", false);
+      if(!m_pPMTWindow)
+        G4Exception("HTPCAnalysisManager::BeginOfRun()", "Analysis002", FatalException,
+                    "Light map calibration needs the PMT windows, use /htpc/geometry/detailLevel full.");
+
+      const HTPCDetectorConstruction *pDetectorConstruction = static_cast<const HTPCDetectorConstruction *>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+      G4int iNbPMTs = 2 * (G4int) pDetectorConstruction->GetGeometryParameter("i_NbPMTS");
+
+      HTPCLightMapGenerator *pGenerator = static_cast<HTPCLightMapGenerator *>(pParticleSource->GetCurrentGenerator());
+      const unsigned piNbBins[3] = {(unsigned) pGenerator->GetNbBins()[0],
+                                    (unsigned) pGenerator->GetNbBins()[1],
+                                    (unsigned) pGenerator->GetNbBins()[2]};
+      const double pdMin[3] = {pGenerator->GetGridMin().x()/mm, pGenerator->GetGridMin().y()/mm, pGenerator->GetGridMin().z()/mm};
+      const double pdMax[3] = {pGenerator->GetGridMax().x()/mm, pGenerator->GetGridMax().y()/mm, pGenerator->GetGridMax().z()/mm};
+
+      m_pLightMapCalibration = new HTPCLightCollectionMap();
+      try {
+        m_pLightMapCalibration->Book(piNbBins, pdMin, pdMax, iNbPMTs);
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::BeginOfRun()", "Analysis003", FatalException, hError.what());
+      }
+
+      if(m_hLightCollectionMapOutput.empty())
+        m_hLightCollectionMapOutput = m_hDataFilename + ".lce";
 
+      G4cout << "HTPCAnalysisManager:: light map calibration, " << m_pLightMapCalibration->GetNbVoxels()
+             << " voxels, " << iNbPMTs << " PMTs, map written to " << m_hLightCollectionMapOutput << G4endl;
+    }
+
+  m_iNbFilteredEvents = m_iNbPassedScatter = m_iNbPassedFiducial = m_iNbPassedEnergy = 0;
+
+  SelectStepQuantities();
+
+  if(!m_bLiquidLevelSet)
+    {
+      const HTPCDetectorConstruction *pDetectorConstruction = static_cast<const HTPCDetectorConstruction *>(
+        G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+      m_pSignalSynthesis->SetLiquidLevel(pDetectorConstruction->GetGeometryParameter("LiquidLevel_Z"));
+    }
+
+  // with the asynchronous writer the file is opened, filled and closed by
+  // the writer thread only
+  m_pTreeEventData = m_pEventData;
+  if(m_bAsyncWrite && m_iOutputMode == kTree)
+    {
+      ROOT::EnableThreadSafety();
+      m_pTreeEventData = new HTPCEventData();
+      m_pWriterQueue = new HTPCAsyncQueue<std::function<void()> >(
+        [](std::function<void()> &hTask) { hTask(); }, m_iAsyncQueueSize);
+      m_pWriterQueue->Push([this]() { OpenOutputFile(); });
+
+      G4cout << "HTPCAnalysisManager:: asynchronous tree writer, " << m_iAsyncQueueSize << " events queued at most" << G4endl;
+    }
+  else
+    OpenOutputFile();
+
+  if(m_bPrimaryTable)
+    {
+      G4String hFilename = m_hDataFilename + ".primaries";
+      if(!m_pPrimaryTable)
+        m_pPrimaryTable = new HTPCPrimaryTable();
+      try {
+        m_pPrimaryTable->Open(hFilename);
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::BeginOfRun()", "Analysis009", FatalException, hError.what());
+      }
+      G4cout << "HTPCAnalysisManager:: primary vertices written to " << hFilename << G4endl;
+    }
+
+  m_pPhaseSpaceVolume = 0;
+  if(!m_hPhaseSpaceVolumeName.empty())
+    {
+      m_pPhaseSpaceVolume = G4PhysicalVolumeStore::GetInstance()->GetVolume(m_hPhaseSpaceVolumeName, false);
+      if(!m_pPhaseSpaceVolume || !m_pPhaseSpaceVolume->GetMotherLogical())
+        G4Exception("HTPCAnalysisManager::BeginOfRun()", "Analysis012", FatalException,
+                    ("No volume " + m_hPhaseSpaceVolumeName + " inside the world for the phase space").c_str());
+
+      m_hPhaseSpaceParticles.clear();
+      std::istringstream hStream(m_hPhaseSpaceParticleNames);
+      G4String hParticleName;
+      while(hStream >> hParticleName)
+        {
+          if(hParticleName == "all")
+            {
+              m_hPhaseSpaceParticles.clear();
+              break;
+            }
+
+          const G4ParticleDefinition *pDefinition = G4ParticleTable::GetParticleTable()->FindParticle(hParticleName);
+          if(!pDefinition)
+            G4Exception("HTPCAnalysisManager::BeginOfRun()", "Analysis016", FatalException,
+                        ("Unknown particle " + hParticleName + " for the phase space").c_str());
+          m_hPhaseSpaceParticles.push_back(pDefinition);
+        }
+
+      G4String hFilename = m_hDataFilename + ".phasespace";
+      if(!m_pPhaseSpaceWriter)
+        m_pPhaseSpaceWriter = new HTPCPhaseSpaceWriter();
+      try {
+        m_pPhaseSpaceWriter->Open(hFilename);
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::BeginOfRun()", "Analysis013", FatalException, hError.what());
+      }
+      G4cout << "HTPCAnalysisManager:: " << (m_hPhaseSpaceParticles.empty() ? G4String("all particles") : m_hPhaseSpaceParticleNames)
+             << " entering " << m_hPhaseSpaceVolumeName
+             << " written to " << hFilename << (m_bPhaseSpaceStop ? " and stopped" : "") << G4endl;
+    }
+}
+
+void
+HTPCAnalysisManager::OpenOutputFile()
+{
   m_pTreeFile = new TFile(m_hDataFilename.c_str(), "RECREATE");//, "File containing event data for Xenon1T");
+  if(m_iCompressionSettings >= 0)
+    m_pTreeFile->SetCompressionSettings(m_iCompressionSettings);
   // make tree structure
   TNamed *G4version = new TNamed("G4VERSION_TAG",G4VERSION_TAG);
   G4version->Write();
 
+  if(m_iOutputMode == kHistograms)
+    BookHistograms();
+  else if(m_iOutputMode == kParquet)
+    OpenParquetWriter();
+  else
+    BookTree();
+
+  m_pNbEventsToSimulateParameter = new TParameter<int>("nbevents", m_iNbEventsToSimulate);
+  m_pNbEventsToSimulateParameter->Write();
+
+  m_pTreeFile->cd();
+
+}
+
+void
+HTPCAnalysisManager::BookTree()
+{
   _events = m_pTreeFile->mkdir("events");
   _events->cd();
 
@@ -63,63 +378,329 @@ HTPCAnalysisManager::BeginOfRun(const G4Run *)
 
   gROOT->ProcessLine("#include <vector>");
 
-  m_pTree->Branch("eventid", &m_pEventData->m_iEventId, "eventid/I");
+  if(IsBranchSelected("eventid")) m_pTree->Branch("eventid", &m_pTreeEventData->m_iEventId, "eventid/I");
   //Figure Uit watter tak om te hou en verander verder soos nodig
-  m_pTree->Branch("ndetectorhits", &m_pEventData->m_iNbPMTHits);
-  m_pTree->Branch("detectorhits", "vector<int>", &m_pEventData->m_pPMTHits);
-
-  m_pTree->Branch("etot", &m_pEventData->m_fTotalEnergyDeposited, "etot/F");
-  m_pTree->Branch("nsteps", &m_pEventData->m_iNbSteps, "nsteps/I");
-  m_pTree->Branch("trackid", "vector<int>", &m_pEventData->m_pTrackId);
-  m_pTree->Branch("type", "vector<string>", &m_pEventData->m_pParticleType);
-  m_pTree->Branch("parentid", "vector<int>", &m_pEventData->m_pParentId);
-  m_pTree->Branch("parenttype", "vector<string>", &m_pEventData->m_pParentType);
-  m_pTree->Branch("creaproc", "vector<string>", &m_pEventData->m_pCreatorProcess);
-  m_pTree->Branch("edproc", "vector<string>", &m_pEventData->m_pDepositingProcess);
-  m_pTree->Branch("PreStepEnergy", "vector<float>", &m_pEventData->m_pPreStepEnergy);
-  m_pTree->Branch("PostStepEnergy", "vector<float>", &m_pEventData->m_pPostStepEnergy);
-  m_pTree->Branch("xp", "vector<float>", &m_pEventData->m_pX);
-  m_pTree->Branch("yp", "vector<float>", &m_pEventData->m_pY);
-  m_pTree->Branch("zp", "vector<float>", &m_pEventData->m_pZ);
-  m_pTree->Branch("ed", "vector<float>", &m_pEventData->m_pEnergyDeposited);
-  m_pTree->Branch("time", "vector<float>", &m_pEventData->m_pTime);
-
-  m_pTree->Branch("type_pri", "vector<string>", &m_pEventData->m_pPrimaryParticleType);
-  m_pTree->Branch("xp_pri", &m_pEventData->m_fPrimaryX, "xp_pri/F");
-  m_pTree->Branch("yp_pri", &m_pEventData->m_fPrimaryY, "yp_pri/F");
-  m_pTree->Branch("zp_pri", &m_pEventData->m_fPrimaryZ, "zp_pri/F");
-  m_pTree->Branch("cx_pri", &m_pEventData->m_fPrimaryCx, "cx_pri/F");
-  m_pTree->Branch("cy_pri", &m_pEventData->m_fPrimaryCy, "cy_pri/F");
-  m_pTree->Branch("cz_pri", &m_pEventData->m_fPrimaryCz, "cz_pri/F");
-  m_pTree->Branch("xp_fcd", &m_pEventData->m_fForcedPrimaryX, "xp_fcd/F");
-  m_pTree->Branch("yp_fcd", &m_pEventData->m_fForcedPrimaryY, "yp_fcd/F");
-  m_pTree->Branch("zp_fcd", &m_pEventData->m_fForcedPrimaryZ, "zp_fcd/F");
-  m_pTree->Branch("e_pri",  &m_pEventData->m_fPrimaryE, "e_pri/F");
-  m_pTree->Branch("w_pri",  &m_pEventData->m_fPrimaryW, "w_pri/F");
+  if(IsBranchSelected("ndetectorhits")) m_pTree->Branch("ndetectorhits", &m_pTreeEventData->m_iNbPMTHits);
+  if(IsBranchSelected("detectorhits")) m_pTree->Branch("detectorhits", &m_pTreeEventData->m_hPMTHits);
 
-  m_pNbEventsToSimulateParameter = new TParameter<int>("nbevents", m_iNbEventsToSimulate);
-  m_pNbEventsToSimulateParameter->Write();
+  if(IsBranchSelected("etot")) m_pTree->Branch("etot", &m_pTreeEventData->m_fTotalEnergyDeposited, "etot/F");
+  if(IsBranchSelected("nsteps")) m_pTree->Branch("nsteps", &m_pTreeEventData->m_iNbSteps, "nsteps/I");
+  if(IsBranchSelected("trackid")) m_pTree->Branch("trackid", &m_pTreeEventData->m_hTrackId);
+  if(IsBranchSelected("type")) m_pTree->Branch("type", &m_pTreeEventData->m_hParticleType);
+  if(IsBranchSelected("parentid")) m_pTree->Branch("parentid", &m_pTreeEventData->m_hParentId);
+  if(IsBranchSelected("parenttype")) m_pTree->Branch("parenttype", &m_pTreeEventData->m_hParentType);
+  if(IsBranchSelected("creaproc")) m_pTree->Branch("creaproc", &m_pTreeEventData->m_hCreatorProcess);
+  if(IsBranchSelected("edproc")) m_pTree->Branch("edproc", &m_pTreeEventData->m_hDepositingProcess);
+  if(IsBranchSelected("PreStepEnergy")) m_pTree->Branch("PreStepEnergy", &m_pTreeEventData->m_hPreStepEnergy);
+  if(IsBranchSelected("PostStepEnergy")) m_pTree->Branch("PostStepEnergy", &m_pTreeEventData->m_hPostStepEnergy);
+  if(IsBranchSelected("xp")) m_pTree->Branch("xp", &m_pTreeEventData->m_hX);
+  if(IsBranchSelected("yp")) m_pTree->Branch("yp", &m_pTreeEventData->m_hY);
+  if(IsBranchSelected("zp")) m_pTree->Branch("zp", &m_pTreeEventData->m_hZ);
+  if(IsBranchSelected("ed")) m_pTree->Branch("ed", &m_pTreeEventData->m_hEnergyDeposited);
+  if(IsBranchSelected("time")) m_pTree->Branch("time", &m_pTreeEventData->m_hTime);
 
-  m_pTreeFile->cd();
+  if(IsBranchSelected("type_pri")) m_pTree->Branch("type_pri", &m_pTreeEventData->m_hPrimaryParticleType);
+  if(IsBranchSelected("xp_pri")) m_pTree->Branch("xp_pri", &m_pTreeEventData->m_fPrimaryX, "xp_pri/F");
+  if(IsBranchSelected("yp_pri")) m_pTree->Branch("yp_pri", &m_pTreeEventData->m_fPrimaryY, "yp_pri/F");
+  if(IsBranchSelected("zp_pri")) m_pTree->Branch("zp_pri", &m_pTreeEventData->m_fPrimaryZ, "zp_pri/F");
+  if(IsBranchSelected("cx_pri")) m_pTree->Branch("cx_pri", &m_pTreeEventData->m_fPrimaryCx, "cx_pri/F");
+  if(IsBranchSelected("cy_pri")) m_pTree->Branch("cy_pri", &m_pTreeEventData->m_fPrimaryCy, "cy_pri/F");
+  if(IsBranchSelected("cz_pri")) m_pTree->Branch("cz_pri", &m_pTreeEventData->m_fPrimaryCz, "cz_pri/F");
+  if(IsBranchSelected("xp_fcd")) m_pTree->Branch("xp_fcd", &m_pTreeEventData->m_fForcedPrimaryX, "xp_fcd/F");
+  if(IsBranchSelected("yp_fcd")) m_pTree->Branch("yp_fcd", &m_pTreeEventData->m_fForcedPrimaryY, "yp_fcd/F");
+  if(IsBranchSelected("zp_fcd")) m_pTree->Branch("zp_fcd", &m_pTreeEventData->m_fForcedPrimaryZ, "zp_fcd/F");
+  if(IsBranchSelected("e_pri")) m_pTree->Branch("e_pri",  &m_pTreeEventData->m_fPrimaryE, "e_pri/F");
+  if(IsBranchSelected("w_pri")) m_pTree->Branch("w_pri",  &m_pTreeEventData->m_fPrimaryW, "w_pri/F");
+
+  if(m_bSignalSynthesis)
+    {
+      if(IsBranchSelected("ncl")) m_pTree->Branch("ncl", &m_pTreeEventData->m_iNbClusters, "ncl/I");
+      if(IsBranchSelected("cl_e")) m_pTree->Branch("cl_e", &m_pTreeEventData->m_hClusterEnergy);
+      if(IsBranchSelected("cl_x")) m_pTree->Branch("cl_x", &m_pTreeEventData->m_hClusterX);
+      if(IsBranchSelected("cl_y")) m_pTree->Branch("cl_y", &m_pTreeEventData->m_hClusterY);
+      if(IsBranchSelected("cl_z")) m_pTree->Branch("cl_z", &m_pTreeEventData->m_hClusterZ);
+      if(IsBranchSelected("cl_nph")) m_pTree->Branch("cl_nph", &m_pTreeEventData->m_hClusterNbPhotons);
+      if(IsBranchSelected("cl_ne")) m_pTree->Branch("cl_ne", &m_pTreeEventData->m_hClusterNbElectrons);
+      if(IsBranchSelected("cl_dt")) m_pTree->Branch("cl_dt", &m_pTreeEventData->m_hClusterDriftTime);
+      if(IsBranchSelected("cl_s1")) m_pTree->Branch("cl_s1", &m_pTreeEventData->m_hClusterS1);
+      if(IsBranchSelected("cl_s2")) m_pTree->Branch("cl_s2", &m_pTreeEventData->m_hClusterS2);
+      if(IsBranchSelected("s1")) m_pTree->Branch("s1", &m_pTreeEventData->m_fS1, "s1/F");
+      if(IsBranchSelected("s2")) m_pTree->Branch("s2", &m_pTreeEventData->m_fS2, "s2/F");
+    }
+
+  // later patterns override earlier ones
+  for(size_t i = 0; i < m_hBasketSizes.size(); i++)
+    m_pTree->SetBasketSize(m_hBasketSizes[i].first.c_str(), m_hBasketSizes[i].second);
+  if(m_bAutoFlushSet)
+    m_pTree->SetAutoFlush(m_iAutoFlush);
+}
+
+void
+HTPCAnalysisManager::BookHistograms()
+{
+  _events = m_pTreeFile->mkdir("histograms");
+  _events->cd();
+  m_pTree = 0;
+
+  G4cout <<"HTPCAnalysisManager:: Init histograms, no event tree is written ..."<<G4endl;
 
+  const HTPCDetectorConstruction *pDetectorConstruction = static_cast<const HTPCDetectorConstruction *>(
+    G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  G4double dRadius = pDetectorConstruction->GetGeometryParameter("TPC_oD")/2;
+  G4double dTop = m_pSignalSynthesis->GetLiquidLevel();
+  G4double dBottom = dTop - (pDetectorConstruction->GetGeometryParameter("TPC_H")
+                             - pDetectorConstruction->GetGeometryParameter("GXe_H"));
+  G4double dEnergyMax = m_dHistogramEnergyMax/keV;
+
+  m_pEnergyHistogram = new TH1F("etot", "total energy deposited;E [keV];events",
+                                m_iHistogramEnergyBins, 0., dEnergyMax);
+  m_pClusterEnergyHistogram = new TH1F("cl_e", "cluster energy;E [keV];clusters",
+                                       m_iHistogramEnergyBins, 0., dEnergyMax);
+  m_pSingleScatterEnergyHistogram = new TH1F("ss_e", "single scatters in the fiducial volume;E [keV];events",
+                                             m_iHistogramEnergyBins, 0., dEnergyMax);
+  m_pClusterXYHistogram = new TH2F("cl_xy", "cluster position;x [mm];y [mm]",
+                                   200, -dRadius/mm, dRadius/mm, 200, -dRadius/mm, dRadius/mm);
+  m_pClusterRZHistogram = new TH2F("cl_r2z", "cluster position;r^{2} [mm^{2}];z [mm]",
+                                   200, 0., dRadius*dRadius/(mm*mm), 200, dBottom/mm, dTop/mm);
+}
+
+void
+HTPCAnalysisManager::OpenParquetWriter()
+{
+  // the ROOT file only keeps the run parameters
+  _events = m_pTreeFile;
+  m_pTree = 0;
+
+#ifdef HTPC_WITH_ARROW
+  G4String hBasename = m_hDataFilename;
+  if(hBasename.size() > 5 && hBasename.substr(hBasename.size() - 5) == ".root")
+    hBasename = hBasename.substr(0, hBasename.size() - 5);
+
+  try {
+    m_pParquetWriter = new HTPCParquetWriter(hBasename, m_iParquetBatchSize);
+  } catch (const std::exception &hError) {
+    G4Exception("HTPCAnalysisManager::OpenParquetWriter()", "Analysis005", FatalException, hError.what());
+  }
+
+  G4cout << "HTPCAnalysisManager:: writing " << hBasename << "_steps.parquet and "
+         << hBasename << "_primaries.parquet" << G4endl;
+#else
+  G4Exception("HTPCAnalysisManager::OpenParquetWriter()", "Analysis005", FatalException,
+              "Parquet output needs a build with -DWITH_ARROW=ON.");
+#endif
+}
+
+void
+HTPCAnalysisManager::FillHistograms(HTPCEventData *pEventData)
+{
+  m_pEnergyHistogram->Fill(pEventData->m_fTotalEnergyDeposited);
+
+  for(G4int i = 0; i < pEventData->m_iNbClusters; i++)
+    {
+      G4double x = pEventData->m_hClusterX[i];
+      G4double y = pEventData->m_hClusterY[i];
+      m_pClusterEnergyHistogram->Fill(pEventData->m_hClusterEnergy[i]);
+      m_pClusterXYHistogram->Fill(x, y);
+      m_pClusterRZHistogram->Fill(x*x + y*y, pEventData->m_hClusterZ[i]);
+    }
+
+  G4bool bFiducial;
+  G4double dEnergy;
+  if(CountScatters(pEventData, bFiducial, dEnergy) == 1 && bFiducial)
+    m_pSingleScatterEnergyHistogram->Fill(dEnergy/keV);
 }
 
 void HTPCAnalysisManager::EndOfRun(const G4Run *, G4int seed) {
   runTime->Stop();
   G4double dt = runTime->GetRealElapsed();
 
+  if(m_pWriterQueue)
+    {
+      // waits for the queued events and the end of the file
+      m_pWriterQueue->Push([this, dt, seed]() { CloseOutputFile(dt, seed); });
+      delete m_pWriterQueue;
+      m_pWriterQueue = 0;
+
+      FreeRecords();
+      delete m_pTreeEventData;
+      m_pTreeEventData = m_pEventData;
+    }
+  else
+    CloseOutputFile(dt, seed);
+
+#ifdef HTPC_WITH_ARROW
+  if(m_pParquetWriter)
+    {
+      try {
+        m_pParquetWriter->Close();
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::EndOfRun()", "Analysis006", FatalException, hError.what());
+      }
+      delete m_pParquetWriter;
+      m_pParquetWriter = 0;
+    }
+#endif
+
+  if(m_pPrimaryTable && m_pPrimaryTable->IsOpen())
+    {
+      try {
+        m_pPrimaryTable->Close();
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::EndOfRun()", "Analysis010", FatalException, hError.what());
+      }
+      G4cout << "HTPCAnalysisManager:: " << m_pPrimaryTable->GetNbRecords() << " primaries written" << G4endl;
+    }
+
+  if(m_pPhaseSpaceWriter && m_pPhaseSpaceWriter->IsOpen())
+    {
+      try {
+        m_pPhaseSpaceWriter->Close();
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::EndOfRun()", "Analysis014", FatalException, hError.what());
+      }
+      G4cout << "HTPCAnalysisManager:: " << m_pPhaseSpaceWriter->GetNbRecords() << " phase space particles written from "
+             << m_pPhaseSpaceWriter->GetNbEvents() << " events of total weight " << m_pPhaseSpaceWriter->GetTotalWeight() << G4endl;
+    }
+
+  if(m_pLightMapCalibration)
+    {
+      try {
+        m_pLightMapCalibration->Write(m_hLightCollectionMapOutput);
+      } catch (const std::exception &hError) {
+        G4Exception("HTPCAnalysisManager::EndOfRun()", "Analysis004", FatalException, hError.what());
+      }
+      G4cout << "HTPCAnalysisManager:: light collection map written to " << m_hLightCollectionMapOutput << G4endl;
+    }
+}
+
+void
+HTPCAnalysisManager::CloseOutputFile(G4double dt, G4int seed)
+{
   // Info to the output file
   TParameter<G4double> *dtPar = new TParameter<G4double>("G4RUNTIME", dt);
   dtPar->Write();
   TParameter<G4int> *m_pRanSeed = new TParameter<int>("RANDOM_SEED", seed);
   m_pRanSeed->Write();
 
+  if(!writeEmptyEvents || m_bFilter)
+    {
+      (new TParameter<int>("nevents_empty", m_iNbEmptyEvents))->Write();
+      G4cout << "HTPCAnalysisManager:: " << m_iNbEmptyEvents << " events without hits not written" << G4endl;
+    }
+
+  if(m_bFilter)
+    {
+      (new TParameter<int>("filter_nevents", m_iNbFilteredEvents))->Write();
+      (new TParameter<int>("filter_nscatter", m_iNbPassedScatter))->Write();
+      (new TParameter<int>("filter_nfiducial", m_iNbPassedFiducial))->Write();
+      (new TParameter<int>("filter_nenergy", m_iNbPassedEnergy))->Write();
+
+      G4cout << "HTPCAnalysisManager:: filter, " << m_iNbPassedEnergy << " of " << m_iNbFilteredEvents
+             << " events written (scatter " << m_iNbPassedScatter << ", fiducial " << m_iNbPassedFiducial
+             << ")" << G4endl;
+    }
+
   m_pTreeFile->cd();
 
   m_pTreeFile->Write();
   m_pTreeFile->Close();
 }
 
+void
+HTPCAnalysisManager::FillTree()
+{
+  if(!m_pWriterQueue)
+    {
+      m_pTree->Fill();
+      return;
+    }
+
+  // hand the event over to the writer thread in a record of the pool, the
+  // vectors are swapped so nothing is copied and their capacity is reused
+  HTPCEventData *pRecord = 0;
+  {
+    std::lock_guard<std::mutex> hLock(m_hRecordMutex);
+    if(!m_hFreeRecords.empty())
+      {
+        pRecord = m_hFreeRecords.back();
+        m_hFreeRecords.pop_back();
+      }
+  }
+  if(!pRecord)
+    {
+      pRecord = new HTPCEventData();
+      pRecord->Reserve(m_iMaxNbSteps, m_iMaxNbClusters);
+    }
+
+  pRecord->Swap(*m_pEventData);
+
+  m_pWriterQueue->Push([this, pRecord]() {
+      m_pTreeEventData->Swap(*pRecord);
+      m_pTree->Fill();
+
+      pRecord->Clear();
+      std::lock_guard<std::mutex> hLock(m_hRecordMutex);
+      m_hFreeRecords.push_back(pRecord);
+    });
+}
+
+void
+HTPCAnalysisManager::FreeRecords()
+{
+  for(size_t i = 0; i < m_hFreeRecords.size(); i++)
+    delete m_hFreeRecords[i];
+  m_hFreeRecords.clear();
+}
+
+void
+HTPCAnalysisManager::AddDetectedPhoton(G4int iPMT)
+{
+  HTPCLightMapGenerator *pGenerator = static_cast<HTPCLightMapGenerator *>(
+    m_pPrimaryGeneratorAction->GetParticleSource()->GetCurrentGenerator());
+  m_pLightMapCalibration->AddDetected(pGenerator->GetCurrentVoxel(), iPMT);
+}
+
+G4bool
+HTPCAnalysisManager::AddPhaseSpaceParticle(const G4Step *pStep)
+{
+  // only particles coming from outside, from the mother or a touching
+  // sister, not from the volume itself or one of its daughters
+  const G4VTouchable *pTouchable = pStep->GetPreStepPoint()->GetTouchable();
+  for(G4int iDepth = 0; iDepth <= pTouchable->GetHistoryDepth(); iDepth++)
+    if(pTouchable->GetVolume(iDepth) == m_pPhaseSpaceVolume)
+      return false;
+
+  const G4Track *pTrack = pStep->GetTrack();
+  const G4ParticleDefinition *pDefinition = pTrack->GetDefinition();
+  if(!m_hPhaseSpaceParticles.empty()
+     && std::find(m_hPhaseSpaceParticles.begin(), m_hPhaseSpaceParticles.end(), pDefinition) == m_hPhaseSpaceParticles.end())
+    return false;
+
+  const G4StepPoint *pPostStepPoint = pStep->GetPostStepPoint();
+  const G4Event *pEvent = G4RunManager::GetRunManager()->GetCurrentEvent();
+
+  HTPCPhaseSpaceWriter::Record hRecord;
+  hRecord.iEventId = pEvent->GetEventID();
+  hRecord.iPDGCode = pDefinition->GetPDGEncoding();
+  hRecord.fX = pPostStepPoint->GetPosition().x()/mm;
+  hRecord.fY = pPostStepPoint->GetPosition().y()/mm;
+  hRecord.fZ = pPostStepPoint->GetPosition().z()/mm;
+  hRecord.fCx = pPostStepPoint->GetMomentumDirection().x();
+  hRecord.fCy = pPostStepPoint->GetMomentumDirection().y();
+  hRecord.fCz = pPostStepPoint->GetMomentumDirection().z();
+  hRecord.fEnergy = pPostStepPoint->GetKineticEnergy()/keV;
+  hRecord.fTime = pPostStepPoint->GetGlobalTime()/ns;
+  hRecord.fWeight = pEvent->GetPrimaryVertex()->GetWeight() * pTrack->GetWeight();
+
+  try {
+    m_pPhaseSpaceWriter->Fill(hRecord);
+  } catch (const std::exception &hError) {
+    G4Exception("HTPCAnalysisManager::AddPhaseSpaceParticle()", "Analysis015", FatalException, hError.what());
+  }
+
+  return m_bPhaseSpaceStop;
+}
+
 void
 HTPCAnalysisManager::BeginOfEvent(const G4Event *)
 {
@@ -134,36 +715,48 @@ HTPCAnalysisManager::BeginOfEvent(const G4Event *)
 void
 HTPCAnalysisManager::EndOfEvent(const G4Event *pEvent)
 {
-  _events->cd();
+  // calibration events only feed the light collection map
+  if(m_pLightMapCalibration)
+    {
+      HTPCLightMapGenerator *pGenerator = static_cast<HTPCLightMapGenerator *>(
+        m_pPrimaryGeneratorAction->GetParticleSource()->GetCurrentGenerator());
+      m_pLightMapCalibration->AddEmitted(pGenerator->GetCurrentVoxel(), pGenerator->GetNbPhotonsOfCurrentVoxel());
+      return;
+    }
 
-  G4HCofThisEvent* pHCofThisEvent = pEvent->GetHCofThisEvent();
-  //G4cout<<"pHCofThisEvent is"<<pHCofThisEvent<<G4endl;
-  //G4cout << pHCofThisEvent->GetCapacity() << G4endl;
-  //G4cout << pHCofThisEvent->GetNumberOfCollections() << G4endl;
-  HTPCDetectorHitsCollection* pDetectorHitsCollection = 0;
+  if(m_pPrimaryTable && m_pPrimaryTable->IsOpen())
+    FillPrimaryTable(pEvent);
 
+  // exposure of the first stage, every event counts for the normalisation
+  if(m_pPhaseSpaceWriter && m_pPhaseSpaceWriter->IsOpen())
+    m_pPhaseSpaceWriter->AddEvent(pEvent->GetNumberOfPrimaryVertex() ? pEvent->GetPrimaryVertex()->GetWeight() : 1.);
 
+  G4HCofThisEvent* pHCofThisEvent = pEvent->GetHCofThisEvent();
+  HTPCDetectorHitsCollection* pDetectorHitsCollection = 0;
   G4int iNbDetectorHits = 0;
 
-  //G4cout<<"pDetectorHitsCollection is "<<pDetectorHitsCollection<<G4endl;
-  //G4cout<<"m_iDetectorHitsCollectionID is "<<m_iDetectorHitsCollectionID<<G4endl;
-
-  if(pHCofThisEvent)
+  if(pHCofThisEvent && m_iDetectorHitsCollectionID != -1)
     {
-      if(m_iDetectorHitsCollectionID != -1)
-	{
-	  pDetectorHitsCollection = (HTPCDetectorHitsCollection *)(pHCofThisEvent->GetHC(m_iDetectorHitsCollectionID));
-	  iNbDetectorHits = (pDetectorHitsCollection)?(pDetectorHitsCollection->entries()):(0);
-	}
+      pDetectorHitsCollection = (HTPCDetectorHitsCollection *)(pHCofThisEvent->GetHC(m_iDetectorHitsCollectionID));
+      iNbDetectorHits = (pDetectorHitsCollection)?(pDetectorHitsCollection->entries()):(0);
     }
 
-  // G4cout<<"pDetectorHitsCollection is "<<pDetectorHitsCollection<<G4endl;
-  // G4cout<<"pDetectorHitsCollection name is "<<pDetectorHitsCollection->GetName()<<G4endl;
+  // events without hits are the bulk of most background runs, when they are
+  // not written (and never pass the filter) they are only counted
+  if(iNbDetectorHits == 0 && (!writeEmptyEvents || m_bFilter))
+    {
+      m_iNbEmptyEvents++;
+      if(m_bFilter)
+        m_iNbFilteredEvents++;
+      return;
+    }
 
+  if(!m_pWriterQueue)
+    _events->cd();
 
   // get the event ID and primary particle information
   m_pEventData->m_iEventId = pEvent->GetEventID();
-  m_pEventData->m_pPrimaryParticleType->push_back(m_pPrimaryGeneratorAction->GetParticleTypeOfPrimary());
+  m_pEventData->m_hPrimaryParticleType.push_back(m_pPrimaryGeneratorAction->GetParticleTypeOfPrimary());
 
   m_pEventData->m_fPrimaryX = m_pPrimaryGeneratorAction->GetPositionOfPrimary().x();
   m_pEventData->m_fPrimaryY = m_pPrimaryGeneratorAction->GetPositionOfPrimary().y();
@@ -184,6 +777,12 @@ HTPCAnalysisManager::EndOfEvent(const G4Event *pEvent)
   G4int iNbSteps = 0;
   G4float fTotalEnergyDeposited = 0.;
 
+  // the selected step vectors are sized for all hits, filled by index and
+  // trimmed to the steps kept afterwards
+  G4bool bKeepSteps = (m_iOutputMode != kHistograms);
+  if(bKeepSteps)
+    ResizeSteps(iNbDetectorHits);
+
   if(iNbDetectorHits)
     {
       //  hits
@@ -191,46 +790,288 @@ HTPCAnalysisManager::EndOfEvent(const G4Event *pEvent)
       for(G4int i=0; i<iNbDetectorHits; i++)
 	{
 	  HTPCDetectorHit *pHit = (*pDetectorHitsCollection)[i];
-	  if(pHit->GetParticleType() != "opticalphoton")
+	  if(pHit->GetParticleType() == "opticalphoton") continue;
+
+	  fTotalEnergyDeposited += pHit->GetEnergyDeposited()/keV;
+	  iNbSteps++;
+
+	  // the steps are only kept in the tree
+	  if(bKeepSteps)
 	    {
-	      m_pEventData->m_pTrackId->push_back(pHit->GetTrackId());
-	      m_pEventData->m_pParentId->push_back(pHit->GetParentId());
-
-	      m_pEventData->m_pParticleType->push_back(pHit->GetParticleType());
-	      m_pEventData->m_pParentType->push_back(pHit->GetParentType());
-	      m_pEventData->m_pCreatorProcess->push_back(pHit->GetCreatorProcess());
-	      m_pEventData->m_pDepositingProcess->push_back(pHit->GetDepositingProcess());
-
-	      m_pEventData->m_pX->push_back(pHit->GetPosition().x()/mm);
-	      m_pEventData->m_pY->push_back(pHit->GetPosition().y()/mm);
-	      m_pEventData->m_pZ->push_back(pHit->GetPosition().z()/mm);
-
-	      fTotalEnergyDeposited += pHit->GetEnergyDeposited()/keV;
-	      m_pEventData->m_pEnergyDeposited->push_back(pHit->GetEnergyDeposited()/keV);
-	      m_pEventData->m_pKineticEnergy->push_back(pHit->GetKineticEnergy()/keV);
-	      m_pEventData->m_pPreStepEnergy->push_back(pHit->GetPreStepEnergy()/keV);
-	      m_pEventData->m_pPostStepEnergy->push_back(pHit->GetPostStepEnergy()/keV);
-	      m_pEventData->m_pTime->push_back(pHit->GetTime()/second);
-
-	      iNbSteps++;
+	      const StepSelection &hKeep = m_hStepSelection;
+	      HTPCEventData &hData = *m_pEventData;
+	      const G4int iStep = iNbSteps - 1;
+	      if(hKeep.bTrackId) hData.m_hTrackId[iStep] = pHit->GetTrackId();
+	      if(hKeep.bParentId) hData.m_hParentId[iStep] = pHit->GetParentId();
+
+	      if(hKeep.bType) hData.m_hParticleType[iStep] = pHit->GetParticleType();
+	      if(hKeep.bParentType) hData.m_hParentType[iStep] = pHit->GetParentType();
+	      if(hKeep.bCreatorProcess) hData.m_hCreatorProcess[iStep] = pHit->GetCreatorProcess();
+	      if(hKeep.bDepositingProcess) hData.m_hDepositingProcess[iStep] = pHit->GetDepositingProcess();
+
+	      const G4ThreeVector &hPosition = pHit->GetPosition();
+	      if(hKeep.bX) hData.m_hX[iStep] = hPosition.x()/mm;
+	      if(hKeep.bY) hData.m_hY[iStep] = hPosition.y()/mm;
+	      if(hKeep.bZ) hData.m_hZ[iStep] = hPosition.z()/mm;
+
+	      if(hKeep.bEnergyDeposited) hData.m_hEnergyDeposited[iStep] = pHit->GetEnergyDeposited()/keV;
+	      if(hKeep.bPreStepEnergy) hData.m_hPreStepEnergy[iStep] = pHit->GetPreStepEnergy()/keV;
+	      if(hKeep.bPostStepEnergy) hData.m_hPostStepEnergy[iStep] = pHit->GetPostStepEnergy()/keV;
+	      if(hKeep.bTime) hData.m_hTime[iStep] = pHit->GetTime()/second;
 	    }
 	  // G4cout <<"SUCCESS"<<G4endl;
 	}
     }
 
+  if(bKeepSteps)
+    ResizeSteps(iNbSteps);
+  if((size_t) iNbSteps > m_iMaxNbSteps)
+    m_iMaxNbSteps = iNbSteps;
+
+  if(m_pLightCollectionMap)
+    FillPMTHits(pDetectorHitsCollection, iNbDetectorHits);
+
+  if(m_bSignalSynthesis || m_bFilter || m_iOutputMode == kHistograms)
+    FillClusters(pDetectorHitsCollection, iNbDetectorHits);
+
   // also write the header information + primary vertex of the empty events....
   m_pEventData->m_iNbSteps = iNbSteps;
   m_pEventData->m_fTotalEnergyDeposited = fTotalEnergyDeposited;
 
   // save only energy depositing events
- if(writeEmptyEvents) {
-    m_pTree->Fill(); // write all events to the tree
+ G4bool bWrite;
+ if(m_bFilter) {
+    bWrite = FilterEvent(m_pEventData);
+  } else if(writeEmptyEvents) {
+    bWrite = true; // write all events to the tree
   } else {
-    if(fTotalEnergyDeposited > 0. || iNbDetectorHits > 0) m_pTree->Fill(); // only events with some activity are written to the tree
+    bWrite = (fTotalEnergyDeposited > 0. || iNbDetectorHits > 0); // only events with some activity are written to the tree
   }
 
+  if(bWrite)
+    {
+      if(m_iOutputMode == kHistograms)
+        FillHistograms(m_pEventData);
+#ifdef HTPC_WITH_ARROW
+      else if(m_iOutputMode == kParquet)
+        m_pParquetWriter->Fill(*m_pEventData);
+#endif
+      else
+        FillTree();
+    }
+
   m_pEventData->Clear();
-  m_pTreeFile->cd();
+  if(!m_pWriterQueue)
+    m_pTreeFile->cd();
+}
+
+void
+HTPCAnalysisManager::FillPrimaryTable(const G4Event *pEvent)
+{
+  // one record per primary particle, e.g. every particle of a decay0
+  // cascade or of a replayed phase space event
+  HTPCPrimaryTable::Record hRecord;
+  hRecord.iEventId = pEvent->GetEventID();
+
+  try {
+    for(G4int iVertex = 0; iVertex < pEvent->GetNumberOfPrimaryVertex(); iVertex++)
+      {
+        const G4PrimaryVertex *pVertex = pEvent->GetPrimaryVertex(iVertex);
+        for(G4int iParticle = 0; iParticle < pVertex->GetNumberOfParticle(); iParticle++)
+          {
+            const G4PrimaryParticle *pParticle = pVertex->GetPrimary(iParticle);
+            const G4ThreeVector &hDirection = pParticle->GetMomentumDirection();
+
+            hRecord.fX = pVertex->GetX0()/mm;
+            hRecord.fY = pVertex->GetY0()/mm;
+            hRecord.fZ = pVertex->GetZ0()/mm;
+            hRecord.fCx = hDirection.x();
+            hRecord.fCy = hDirection.y();
+            hRecord.fCz = hDirection.z();
+            hRecord.fEnergy = pParticle->GetKineticEnergy()/keV;
+            hRecord.fWeight = pVertex->GetWeight() * pParticle->GetWeight();
+            m_pPrimaryTable->Fill(hRecord);
+          }
+      }
+  } catch (const std::exception &hError) {
+    G4Exception("HTPCAnalysisManager::FillPrimaryTable()", "Analysis011", FatalException, hError.what());
+  }
+}
+
+void
+HTPCAnalysisManager::ResizeSteps(size_t iNbSteps)
+{
+  // dropped quantities stay empty
+  const StepSelection &hKeep = m_hStepSelection;
+  HTPCEventData &hData = *m_pEventData;
+  if(hKeep.bTrackId) hData.m_hTrackId.resize(iNbSteps);
+  if(hKeep.bParentId) hData.m_hParentId.resize(iNbSteps);
+  if(hKeep.bType) hData.m_hParticleType.resize(iNbSteps);
+  if(hKeep.bParentType) hData.m_hParentType.resize(iNbSteps);
+  if(hKeep.bCreatorProcess) hData.m_hCreatorProcess.resize(iNbSteps);
+  if(hKeep.bDepositingProcess) hData.m_hDepositingProcess.resize(iNbSteps);
+  if(hKeep.bX) hData.m_hX.resize(iNbSteps);
+  if(hKeep.bY) hData.m_hY.resize(iNbSteps);
+  if(hKeep.bZ) hData.m_hZ.resize(iNbSteps);
+  if(hKeep.bEnergyDeposited) hData.m_hEnergyDeposited.resize(iNbSteps);
+  if(hKeep.bPreStepEnergy) hData.m_hPreStepEnergy.resize(iNbSteps);
+  if(hKeep.bPostStepEnergy) hData.m_hPostStepEnergy.resize(iNbSteps);
+  if(hKeep.bTime) hData.m_hTime.resize(iNbSteps);
+}
+
+void
+HTPCAnalysisManager::FillPMTHits(HTPCDetectorHitsCollection *pDetectorHitsCollection, G4int iNbDetectorHits)
+{
+  // expected number of detected photons per PMT summed over the deposits,
+  // sampled once per PMT: the detected photons of a Poisson number of
+  // emitted photons are Poisson in every PMT
+  m_hExpectedPMTHits.assign(m_pLightCollectionMap->GetNbPMTs(), 0.);
+
+  for(G4int i=0; i<iNbDetectorHits; i++)
+    {
+      HTPCDetectorHit *pHit = (*pDetectorHitsCollection)[i];
+      if(pHit->GetParticleType() == "opticalphoton") continue;
+
+      // same light yield as the S1 of HTPCSignalSynthesis, with quenching
+      // and recombination of nuclear recoils
+      G4double dNbPhotons = m_pSignalSynthesis->GetMeanNbPhotons(pHit->GetEnergyDeposited(),
+                                                                 IsNuclearRecoil(pHit->GetParticleType()));
+      if(dNbPhotons <= 0.) continue;
+
+      G4ThreeVector hPosition = pHit->GetPosition()/mm;
+      long iVoxel = m_pLightCollectionMap->FindVoxel(hPosition.x(), hPosition.y(), hPosition.z());
+      if(iVoxel < 0) continue;
+
+      for(size_t iEntry = m_pLightCollectionMap->GetFirstEntry(iVoxel);
+          iEntry < m_pLightCollectionMap->GetLastEntry(iVoxel); iEntry++)
+        m_hExpectedPMTHits[m_pLightCollectionMap->GetPMT(iEntry)] +=
+          dNbPhotons * m_pLightCollectionMap->GetProbability(iEntry);
+    }
+
+  G4int iNbPMTHits = 0;
+  m_pEventData->m_hPMTHits.resize(m_hExpectedPMTHits.size());
+  for(size_t iPMT = 0; iPMT < m_hExpectedPMTHits.size(); iPMT++)
+    {
+      G4int iNbHits = (m_hExpectedPMTHits[iPMT] > 0.) ? (G4int) G4Poisson(m_hExpectedPMTHits[iPMT]) : 0;
+      m_pEventData->m_hPMTHits[iPMT] = iNbHits;
+      iNbPMTHits += iNbHits;
+    }
+  m_pEventData->m_iNbPMTHits = iNbPMTHits;
+}
+
+void
+HTPCAnalysisManager::FillClusters(HTPCDetectorHitsCollection *pDetectorHitsCollection, G4int iNbDetectorHits)
+{
+  m_hDeposits.clear();
+  for(G4int i=0; i<iNbDetectorHits; i++)
+    {
+      HTPCDetectorHit *pHit = (*pDetectorHitsCollection)[i];
+      if(pHit->GetParticleType() == "opticalphoton") continue;
+
+      HTPCSignalSynthesis::Deposit hDeposit;
+      hDeposit.hPosition = pHit->GetPosition();
+      hDeposit.dEnergy = pHit->GetEnergyDeposited();
+      hDeposit.bNuclearRecoil = IsNuclearRecoil(pHit->GetParticleType());
+      m_hDeposits.push_back(hDeposit);
+    }
+
+  m_pSignalSynthesis->Process(m_hDeposits, m_hClusters);
+
+  size_t iNbClusters = m_hClusters.size();
+  if(iNbClusters > m_iMaxNbClusters)
+    m_iMaxNbClusters = iNbClusters;
+
+  HTPCEventData &hData = *m_pEventData;
+  hData.m_iNbClusters = iNbClusters;
+  hData.m_hClusterEnergy.resize(iNbClusters);
+  hData.m_hClusterX.resize(iNbClusters);
+  hData.m_hClusterY.resize(iNbClusters);
+  hData.m_hClusterZ.resize(iNbClusters);
+  hData.m_hClusterNbPhotons.resize(iNbClusters);
+  hData.m_hClusterNbElectrons.resize(iNbClusters);
+  hData.m_hClusterDriftTime.resize(iNbClusters);
+  hData.m_hClusterS1.resize(iNbClusters);
+  hData.m_hClusterS2.resize(iNbClusters);
+  for(size_t i = 0; i < iNbClusters; i++)
+    {
+      const HTPCSignalSynthesis::Cluster &hCluster = m_hClusters[i];
+      hData.m_hClusterEnergy[i] = hCluster.dEnergy/keV;
+      hData.m_hClusterX[i] = hCluster.hPosition.x()/mm;
+      hData.m_hClusterY[i] = hCluster.hPosition.y()/mm;
+      hData.m_hClusterZ[i] = hCluster.hPosition.z()/mm;
+      hData.m_hClusterNbPhotons[i] = hCluster.iNbPhotons;
+      hData.m_hClusterNbElectrons[i] = hCluster.iNbElectrons;
+      hData.m_hClusterDriftTime[i] = hCluster.dDriftTime/microsecond;
+      hData.m_hClusterS1[i] = hCluster.dS1;
+      hData.m_hClusterS2[i] = hCluster.dS2;
+      hData.m_fS1 += hCluster.dS1;
+      hData.m_fS2 += hCluster.dS2;
+    }
+}
+
+G4int
+HTPCAnalysisManager::CountScatters(HTPCEventData *pEventData, G4bool &bFiducial, G4double &dEnergy)
+{
+  // scatters are the clusters above threshold, the energy is the sum of all
+  // clusters
+  G4int iNbScatters = 0;
+  bFiducial = true;
+  dEnergy = 0.;
+  for(G4int i = 0; i < pEventData->m_iNbClusters; i++)
+    {
+      G4double dClusterEnergy = pEventData->m_hClusterEnergy[i]*keV;
+      dEnergy += dClusterEnergy;
+      if(dClusterEnergy < m_dScatterThreshold) continue;
+
+      iNbScatters++;
+
+      G4double x = pEventData->m_hClusterX[i]*mm;
+      G4double y = pEventData->m_hClusterY[i]*mm;
+      G4double z = pEventData->m_hClusterZ[i]*mm;
+      if(x*x + y*y > m_dFiducialRadius*m_dFiducialRadius || z < m_dFiducialZMin || z > m_dFiducialZMax)
+        bFiducial = false;
+    }
+
+  return iNbScatters;
+}
+
+G4bool
+HTPCAnalysisManager::FilterEvent(HTPCEventData *pEventData)
+{
+  m_iNbFilteredEvents++;
+
+  G4bool bFiducial;
+  G4double dEnergy;
+  G4int iNbScatters = CountScatters(pEventData, bFiducial, dEnergy);
+
+  if(iNbScatters == 0) return false;
+  if(m_iScatterSelection == kSingleScatter && iNbScatters != 1) return false;
+  if(m_iScatterSelection == kMultipleScatter && iNbScatters < 2) return false;
+  m_iNbPassedScatter++;
+
+  if(!bFiducial) return false;
+  m_iNbPassedFiducial++;
+
+  if(dEnergy < m_dEnergyMin || dEnergy > m_dEnergyMax) return false;
+  m_iNbPassedEnergy++;
+
+  return true;
+}
+
+G4bool
+HTPCAnalysisManager::IsNuclearRecoil(const G4String &hParticleType)
+{
+  // recoiling nuclei heavier than alphas quench like nuclear recoils
+  map<G4String, G4bool>::const_iterator pIt = m_hNuclearRecoilTypes.find(hParticleType);
+  if(pIt != m_hNuclearRecoilTypes.end())
+    return pIt->second;
+
+  G4ParticleDefinition *pDefinition = G4ParticleTable::GetParticleTable()->FindParticle(hParticleType);
+  G4bool bNuclearRecoil = pDefinition && pDefinition->GetParticleType() == "nucleus"
+    && pDefinition->GetBaryonNumber() > 4;
+  m_hNuclearRecoilTypes[hParticleType] = bNuclearRecoil;
+
+  return bNuclearRecoil;
 }
 
 void HTPCAnalysisManager::Step(const G4Step *)
@@ -0,0 +1,466 @@
+#include "HTPCAnalysisMessenger.hh"
+#include "HTPCAnalysisManager.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIdirectory.hh"
+#include "globals.hh"
+
+#include <sstream>
+
+HTPCAnalysisMessenger::HTPCAnalysisMessenger(
+  HTPCAnalysisManager* pAnalysisManager)
+  : m_pAnalysisManager(pAnalysisManager)
+{
+  m_pSignalDirectory = new G4UIdirectory("/htpc/signal/");
+  m_pSignalDirectory->SetGuidance("Detector response computed at the end of each event.");
+
+  m_pLightCollectionMapCmd = new G4UIcmdWithAString("/htpc/signal/lceMap", this);
+  m_pLightCollectionMapCmd->SetGuidance("Light collection map used to convert the energy deposits");
+  m_pLightCollectionMapCmd->SetGuidance("into photon counts per PMT (ndetectorhits, detectorhits).");
+  m_pLightCollectionMapCmd->SetParameterName("filename", false);
+  m_pLightCollectionMapCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pLightCollectionMapOutputCmd = new G4UIcmdWithAString("/htpc/signal/lceMapOutput", this);
+  m_pLightCollectionMapOutputCmd->SetGuidance("Light collection map written by an optical calibration run");
+  m_pLightCollectionMapOutputCmd->SetGuidance("(/xe/gun/generator lightmap), default <output file>.lce.");
+  m_pLightCollectionMapOutputCmd->SetParameterName("filename", false);
+  m_pLightCollectionMapOutputCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pSynthesisCmd = new G4UIcmdWithABool("/htpc/signal/synthesis", this);
+  m_pSynthesisCmd->SetGuidance("Cluster the energy deposits into interactions and compute their S1/S2");
+  m_pSynthesisCmd->SetGuidance("areas (ncl, cl_*, s1, s2 branches), default false.");
+  m_pSynthesisCmd->SetParameterName("enable", false);
+  m_pSynthesisCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pG1Cmd = new G4UIcmdWithADouble("/htpc/signal/g1", this);
+  m_pG1Cmd->SetGuidance("Probability that a scintillation photon is detected (default 0.15).");
+  m_pG1Cmd->SetParameterName("g1", false);
+  m_pG1Cmd->SetRange("g1 >= 0. && g1 <= 1.");
+  m_pG1Cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pSingleElectronGainCmd = new G4UIcmdWithADouble("/htpc/signal/seGain", this);
+  m_pSingleElectronGainCmd->SetGuidance("S2 photoelectrons per extracted electron (default 25).");
+  m_pSingleElectronGainCmd->SetParameterName("gain", false);
+  m_pSingleElectronGainCmd->SetRange("gain >= 0.");
+  m_pSingleElectronGainCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pExtractionCmd = new G4UIcmdWithADouble("/htpc/signal/extraction", this);
+  m_pExtractionCmd->SetGuidance("Electron extraction efficiency into the gas (default 0.9).");
+  m_pExtractionCmd->SetParameterName("efficiency", false);
+  m_pExtractionCmd->SetRange("efficiency >= 0. && efficiency <= 1.");
+  m_pExtractionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pDriftVelocityCmd = new G4UIcmdWithADouble("/htpc/signal/driftVelocity", this);
+  m_pDriftVelocityCmd->SetGuidance("Electron drift velocity in mm/us (default 1.5).");
+  m_pDriftVelocityCmd->SetParameterName("velocity", false);
+  m_pDriftVelocityCmd->SetRange("velocity > 0.");
+  m_pDriftVelocityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pElectronLifetimeCmd = new G4UIcmdWithADoubleAndUnit("/htpc/signal/electronLifetime", this);
+  m_pElectronLifetimeCmd->SetGuidance("Electron lifetime in the liquid (default 5 ms, 0 = no attachment).");
+  m_pElectronLifetimeCmd->SetParameterName("lifetime", false);
+  m_pElectronLifetimeCmd->SetRange("lifetime >= 0.");
+  m_pElectronLifetimeCmd->SetDefaultUnit("us");
+  m_pElectronLifetimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pRecombinationCmd = new G4UIcommand("/htpc/signal/recombination", this);
+  m_pRecombinationCmd->SetGuidance("Fraction of the ions that recombine for electronic and nuclear");
+  m_pRecombinationCmd->SetGuidance("recoils (default 0.4 0.6).");
+  G4UIparameter *pParameter = new G4UIparameter("er", 'd', false);
+  pParameter->SetParameterRange("er >= 0. && er <= 1.");
+  m_pRecombinationCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("nr", 'd', false);
+  pParameter->SetParameterRange("nr >= 0. && nr <= 1.");
+  m_pRecombinationCmd->SetParameter(pParameter);
+  m_pRecombinationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pClusterScaleCmd = new G4UIcmdWithADoubleAndUnit("/htpc/signal/clusterScale", this);
+  m_pClusterScaleCmd->SetGuidance("Distance between consecutive deposits above which a new interaction");
+  m_pClusterScaleCmd->SetGuidance("starts (default 10 mm, as analysis/proc_root_reduced.py).");
+  m_pClusterScaleCmd->SetParameterName("scale", false);
+  m_pClusterScaleCmd->SetRange("scale > 0.");
+  m_pClusterScaleCmd->SetDefaultUnit("mm");
+  m_pClusterScaleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pLiquidLevelCmd = new G4UIcmdWithADoubleAndUnit("/htpc/signal/liquidLevel", this);
+  m_pLiquidLevelCmd->SetGuidance("z of the liquid surface the electrons drift to (default: top of LXeActive).");
+  m_pLiquidLevelCmd->SetParameterName("z", false);
+  m_pLiquidLevelCmd->SetDefaultUnit("mm");
+  m_pLiquidLevelCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pFilterDirectory = new G4UIdirectory("/htpc/filter/");
+  m_pFilterDirectory->SetGuidance("Write only the events passing scatter, fiducial and energy cuts.");
+
+  m_pFilterCmd = new G4UIcmdWithABool("/htpc/filter/enable", this);
+  m_pFilterCmd->SetGuidance("Enable the event filter (default false). The number of events passing");
+  m_pFilterCmd->SetGuidance("each cut is written as filter_n* parameters.");
+  m_pFilterCmd->SetParameterName("enable", false);
+  m_pFilterCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pScatterCmd = new G4UIcmdWithAString("/htpc/filter/scatter", this);
+  m_pScatterCmd->SetGuidance("Keep single scatters (ss), multiple scatters (ms) or both (any).");
+  m_pScatterCmd->SetParameterName("selection", false);
+  m_pScatterCmd->SetCandidates("any ss ms");
+  m_pScatterCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pScatterThresholdCmd = new G4UIcmdWithADoubleAndUnit("/htpc/filter/scatterThreshold", this);
+  m_pScatterThresholdCmd->SetGuidance("Clusters below this energy do not count as scatters (default 1 keV).");
+  m_pScatterThresholdCmd->SetParameterName("energy", false);
+  m_pScatterThresholdCmd->SetRange("energy >= 0.");
+  m_pScatterThresholdCmd->SetDefaultUnit("keV");
+  m_pScatterThresholdCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pFiducialRadiusCmd = new G4UIcmdWithADoubleAndUnit("/htpc/filter/fiducialRadius", this);
+  m_pFiducialRadiusCmd->SetGuidance("Maximum radius of every scatter.");
+  m_pFiducialRadiusCmd->SetParameterName("radius", false);
+  m_pFiducialRadiusCmd->SetRange("radius > 0.");
+  m_pFiducialRadiusCmd->SetDefaultUnit("mm");
+  m_pFiducialRadiusCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pFiducialZCmd = new G4UIcommand("/htpc/filter/fiducialZ", this);
+  m_pFiducialZCmd->SetGuidance("z range of every scatter.");
+  pParameter = new G4UIparameter("zmin", 'd', false);
+  m_pFiducialZCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("zmax", 'd', false);
+  m_pFiducialZCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("unit", 's', true);
+  pParameter->SetDefaultUnit("mm");
+  m_pFiducialZCmd->SetParameter(pParameter);
+  m_pFiducialZCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pEnergyWindowCmd = new G4UIcommand("/htpc/filter/energyWindow", this);
+  m_pEnergyWindowCmd->SetGuidance("Range of the total energy of the clusters.");
+  pParameter = new G4UIparameter("emin", 'd', false);
+  m_pEnergyWindowCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("emax", 'd', false);
+  m_pEnergyWindowCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("unit", 's', true);
+  pParameter->SetDefaultUnit("keV");
+  m_pEnergyWindowCmd->SetParameter(pParameter);
+  m_pEnergyWindowCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pOutputDirectory = new G4UIdirectory("/htpc/output/");
+  m_pOutputDirectory->SetGuidance("Content of the output file.");
+
+  m_pOutputModeCmd = new G4UIcmdWithAString("/htpc/output/mode", this);
+  m_pOutputModeCmd->SetGuidance("tree: one entry per event (default).");
+  m_pOutputModeCmd->SetGuidance("histograms: energy spectra and cluster positions only.");
+  m_pOutputModeCmd->SetGuidance("parquet: steps and primaries as Parquet tables (needs -DWITH_ARROW=ON).");
+  m_pOutputModeCmd->SetParameterName("mode", false);
+  m_pOutputModeCmd->SetCandidates("tree histograms parquet");
+  m_pOutputModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pEnergyBinningCmd = new G4UIcommand("/htpc/output/energyBinning", this);
+  m_pEnergyBinningCmd->SetGuidance("Number of bins and upper edge of the energy histograms");
+  m_pEnergyBinningCmd->SetGuidance("(default 3000 bins up to 3000 keV).");
+  pParameter = new G4UIparameter("bins", 'i', false);
+  pParameter->SetParameterRange("bins > 0");
+  m_pEnergyBinningCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("emax", 'd', false);
+  pParameter->SetParameterRange("emax > 0.");
+  m_pEnergyBinningCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("unit", 's', true);
+  pParameter->SetDefaultUnit("keV");
+  m_pEnergyBinningCmd->SetParameter(pParameter);
+  m_pEnergyBinningCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pParquetBatchSizeCmd = new G4UIcmdWithAnInteger("/htpc/output/parquetBatchSize", this);
+  m_pParquetBatchSizeCmd->SetGuidance("Steps per Parquet record batch (row group), default 100000.");
+  m_pParquetBatchSizeCmd->SetParameterName("steps", false);
+  m_pParquetBatchSizeCmd->SetRange("steps > 0");
+  m_pParquetBatchSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pAsyncWriteCmd = new G4UIcmdWithABool("/htpc/output/asyncWrite", this);
+  m_pAsyncWriteCmd->SetGuidance("Fill, compress and write the tree on a separate thread that owns the");
+  m_pAsyncWriteCmd->SetGuidance("output file, so the event loop does not wait for I/O (default false).");
+  m_pAsyncWriteCmd->SetParameterName("enable", false);
+  m_pAsyncWriteCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pAsyncQueueSizeCmd = new G4UIcmdWithAnInteger("/htpc/output/asyncQueueSize", this);
+  m_pAsyncQueueSizeCmd->SetGuidance("Events waiting for the writer thread before the event loop blocks (default 64).");
+  m_pAsyncQueueSizeCmd->SetParameterName("events", false);
+  m_pAsyncQueueSizeCmd->SetRange("events > 0");
+  m_pAsyncQueueSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pPrimaryTableCmd = new G4UIcmdWithABool("/htpc/output/primaryTable", this);
+  m_pPrimaryTableCmd->SetGuidance("Write every primary particle of every event, including the empty and filtered");
+  m_pPrimaryTableCmd->SetGuidance("ones, to <output file>.primaries for normalisation (default false).");
+  m_pPrimaryTableCmd->SetParameterName("enable", false);
+  m_pPrimaryTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pCompressionCmd = new G4UIcommand("/htpc/output/compression", this);
+  m_pCompressionCmd->SetGuidance("Compression algorithm and level (1-9) of the output file.");
+  pParameter = new G4UIparameter("algorithm", 's', false);
+  pParameter->SetParameterCandidates("none zlib lzma lz4 zstd");
+  m_pCompressionCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("level", 'i', true);
+  pParameter->SetDefaultValue(4);
+  pParameter->SetParameterRange("level >= 0 && level <= 9");
+  m_pCompressionCmd->SetParameter(pParameter);
+  m_pCompressionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pBasketSizeCmd = new G4UIcommand("/htpc/output/basketSize", this);
+  m_pBasketSizeCmd->SetGuidance("Basket size in bytes of the branches matching a pattern, e.g.");
+  m_pBasketSizeCmd->SetGuidance("'xp' or 'cl_*'. Applied in the order given.");
+  pParameter = new G4UIparameter("branches", 's', false);
+  m_pBasketSizeCmd->SetParameter(pParameter);
+  pParameter = new G4UIparameter("bytes", 'i', false);
+  pParameter->SetParameterRange("bytes > 0");
+  m_pBasketSizeCmd->SetParameter(pParameter);
+  m_pBasketSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pAutoFlushCmd = new G4UIcmdWithAnInteger("/htpc/output/autoFlush", this);
+  m_pAutoFlushCmd->SetGuidance("Cluster size of the tree: flush the baskets every n entries, or every");
+  m_pAutoFlushCmd->SetGuidance("-n bytes written for a negative value (TTree::SetAutoFlush).");
+  m_pAutoFlushCmd->SetParameterName("n", false);
+  m_pAutoFlushCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pPresetCmd = new G4UIcmdWithAString("/htpc/output/preset", this);
+  m_pPresetCmd->SetGuidance("fastWrite: LZ4, 256 kB baskets, 50 MB clusters.");
+  m_pPresetCmd->SetGuidance("smallArchive: LZMA level 8, 512 kB baskets, 100 MB clusters.");
+  m_pPresetCmd->SetGuidance("default: ROOT defaults. Later storage commands refine a preset.");
+  m_pPresetCmd->SetParameterName("preset", false);
+  m_pPresetCmd->SetCandidates("fastWrite smallArchive default");
+  m_pPresetCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pKeepCmd = new G4UIcmdWithAString("/htpc/output/keep", this);
+  m_pKeepCmd->SetGuidance("Write the branches matching a pattern ('*' wildcards). Rules apply in");
+  m_pKeepCmd->SetGuidance("order, the last one matching a branch decides.");
+  m_pKeepCmd->SetParameterName("branches", false);
+  m_pKeepCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pDropCmd = new G4UIcmdWithAString("/htpc/output/drop", this);
+  m_pDropCmd->SetGuidance("Do not fill nor write the branches matching a pattern ('*' wildcards).");
+  m_pDropCmd->SetParameterName("branches", false);
+  m_pDropCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pProfileCmd = new G4UIcmdWithAString("/htpc/output/profile", this);
+  m_pProfileCmd->SetGuidance("Replace the keep/drop rules by a profile:");
+  m_pProfileCmd->SetGuidance("full: every branch (default).");
+  m_pProfileCmd->SetGuidance("minimal: eventid, etot, nsteps, xp, yp, zp, ed and the primary.");
+  m_pProfileCmd->SetGuidance("signal: eventid, etot, clusters, s1, s2 and the primary.");
+  m_pProfileCmd->SetParameterName("profile", false);
+  m_pProfileCmd->SetCandidates("full minimal signal");
+  m_pProfileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pWriteEmptyCmd = new G4UIcmdWithABool("/run/writeEmpty", this);
+  m_pWriteEmptyCmd->SetGuidance("Write the events without any energy deposit (default true). Otherwise");
+  m_pWriteEmptyCmd->SetGuidance("they are only counted (nevents_empty in the output file).");
+  m_pWriteEmptyCmd->SetParameterName("write", false);
+  m_pWriteEmptyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pPhaseSpaceDirectory = new G4UIdirectory("/htpc/phasespace/");
+  m_pPhaseSpaceDirectory->SetGuidance("First stage of a two-stage simulation: particles entering a volume are written");
+  m_pPhaseSpaceDirectory->SetGuidance("to <output file>.phasespace for the phasespace generator.");
+
+  m_pPhaseSpaceVolumeCmd = new G4UIcmdWithAString("/htpc/phasespace/volume", this);
+  m_pPhaseSpaceVolumeCmd->SetGuidance("Physical volume whose entering particles are recorded, e.g. phys_oCryostat.");
+  m_pPhaseSpaceVolumeCmd->SetParameterName("volume", false);
+  m_pPhaseSpaceVolumeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pPhaseSpaceStopCmd = new G4UIcmdWithABool("/htpc/phasespace/stop", this);
+  m_pPhaseSpaceStopCmd->SetGuidance("Stop the recorded particles at the surface of the volume (default true).");
+  m_pPhaseSpaceStopCmd->SetParameterName("stop", false);
+  m_pPhaseSpaceStopCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pPhaseSpaceParticlesCmd = new G4UIcmdWithAString("/htpc/phasespace/particles", this);
+  m_pPhaseSpaceParticlesCmd->SetGuidance("Names of the recorded particles (default \"neutron gamma\"), or all.");
+  m_pPhaseSpaceParticlesCmd->SetParameterName("particles", false);
+  m_pPhaseSpaceParticlesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+HTPCAnalysisMessenger::~HTPCAnalysisMessenger()
+{
+  delete m_pLightCollectionMapCmd;
+  delete m_pLightCollectionMapOutputCmd;
+  delete m_pSynthesisCmd;
+  delete m_pG1Cmd;
+  delete m_pSingleElectronGainCmd;
+  delete m_pExtractionCmd;
+  delete m_pDriftVelocityCmd;
+  delete m_pElectronLifetimeCmd;
+  delete m_pRecombinationCmd;
+  delete m_pClusterScaleCmd;
+  delete m_pLiquidLevelCmd;
+  delete m_pFilterCmd;
+  delete m_pScatterCmd;
+  delete m_pScatterThresholdCmd;
+  delete m_pFiducialRadiusCmd;
+  delete m_pFiducialZCmd;
+  delete m_pEnergyWindowCmd;
+  delete m_pFilterDirectory;
+  delete m_pOutputModeCmd;
+  delete m_pEnergyBinningCmd;
+  delete m_pParquetBatchSizeCmd;
+  delete m_pAsyncWriteCmd;
+  delete m_pAsyncQueueSizeCmd;
+  delete m_pPrimaryTableCmd;
+  delete m_pCompressionCmd;
+  delete m_pBasketSizeCmd;
+  delete m_pAutoFlushCmd;
+  delete m_pPresetCmd;
+  delete m_pKeepCmd;
+  delete m_pDropCmd;
+  delete m_pProfileCmd;
+  delete m_pWriteEmptyCmd;
+  delete m_pPhaseSpaceVolumeCmd;
+  delete m_pPhaseSpaceStopCmd;
+  delete m_pPhaseSpaceParticlesCmd;
+  delete m_pPhaseSpaceDirectory;
+  delete m_pOutputDirectory;
+  delete m_pSignalDirectory;
+}
+
+void HTPCAnalysisMessenger::SetNewValue(G4UIcommand* command,
+    G4String newValue)
+{
+  if (command == m_pLightCollectionMapCmd)
+    m_pAnalysisManager->SetLightCollectionMap(newValue);
+
+  if (command == m_pLightCollectionMapOutputCmd)
+    m_pAnalysisManager->SetLightCollectionMapOutput(newValue);
+
+  if (command == m_pSynthesisCmd)
+    m_pAnalysisManager->SetSignalSynthesis(m_pSynthesisCmd->GetNewBoolValue(newValue));
+
+  HTPCSignalSynthesis *pSignalSynthesis = m_pAnalysisManager->GetSignalSynthesis();
+
+  if (command == m_pG1Cmd)
+    pSignalSynthesis->SetG1(m_pG1Cmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pSingleElectronGainCmd)
+    pSignalSynthesis->SetSingleElectronGain(m_pSingleElectronGainCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pExtractionCmd)
+    pSignalSynthesis->SetExtractionEfficiency(m_pExtractionCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pDriftVelocityCmd)
+    pSignalSynthesis->SetDriftVelocity(m_pDriftVelocityCmd->GetNewDoubleValue(newValue)*mm/microsecond);
+
+  if (command == m_pElectronLifetimeCmd)
+    pSignalSynthesis->SetElectronLifetime(m_pElectronLifetimeCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pRecombinationCmd)
+    {
+      G4double dElectronRecoil, dNuclearRecoil;
+      std::istringstream hStream(newValue);
+      hStream >> dElectronRecoil >> dNuclearRecoil;
+      pSignalSynthesis->SetRecombination(dElectronRecoil, dNuclearRecoil);
+    }
+
+  if (command == m_pClusterScaleCmd)
+    pSignalSynthesis->SetClusterScale(m_pClusterScaleCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pLiquidLevelCmd)
+    m_pAnalysisManager->SetLiquidLevel(m_pLiquidLevelCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pFilterCmd)
+    m_pAnalysisManager->SetFilter(m_pFilterCmd->GetNewBoolValue(newValue));
+
+  if (command == m_pScatterCmd)
+    {
+      if (newValue == "ss")
+        m_pAnalysisManager->SetScatterSelection(HTPCAnalysisManager::kSingleScatter);
+      else if (newValue == "ms")
+        m_pAnalysisManager->SetScatterSelection(HTPCAnalysisManager::kMultipleScatter);
+      else
+        m_pAnalysisManager->SetScatterSelection(HTPCAnalysisManager::kAnyScatter);
+    }
+
+  if (command == m_pScatterThresholdCmd)
+    m_pAnalysisManager->SetScatterThreshold(m_pScatterThresholdCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pFiducialRadiusCmd)
+    m_pAnalysisManager->SetFiducialRadius(m_pFiducialRadiusCmd->GetNewDoubleValue(newValue));
+
+  if (command == m_pFiducialZCmd || command == m_pEnergyWindowCmd)
+    {
+      G4double dMin, dMax;
+      G4String hUnit;
+      std::istringstream hStream(newValue);
+      hStream >> dMin >> dMax >> hUnit;
+      G4double dUnit = G4UIcommand::ValueOf(hUnit);
+
+      if (command == m_pFiducialZCmd)
+        m_pAnalysisManager->SetFiducialZ(dMin*dUnit, dMax*dUnit);
+      else
+        m_pAnalysisManager->SetEnergyWindow(dMin*dUnit, dMax*dUnit);
+    }
+
+  if (command == m_pOutputModeCmd)
+    {
+      if (newValue == "histograms")
+        m_pAnalysisManager->SetOutputMode(HTPCAnalysisManager::kHistograms);
+      else if (newValue == "parquet")
+        m_pAnalysisManager->SetOutputMode(HTPCAnalysisManager::kParquet);
+      else
+        m_pAnalysisManager->SetOutputMode(HTPCAnalysisManager::kTree);
+    }
+
+  if (command == m_pParquetBatchSizeCmd)
+    m_pAnalysisManager->SetParquetBatchSize(m_pParquetBatchSizeCmd->GetNewIntValue(newValue));
+
+  if (command == m_pAsyncWriteCmd)
+    m_pAnalysisManager->SetAsyncWrite(m_pAsyncWriteCmd->GetNewBoolValue(newValue));
+
+  if (command == m_pAsyncQueueSizeCmd)
+    m_pAnalysisManager->SetAsyncQueueSize(m_pAsyncQueueSizeCmd->GetNewIntValue(newValue));
+
+  if (command == m_pPrimaryTableCmd)
+    m_pAnalysisManager->SetPrimaryTable(m_pPrimaryTableCmd->GetNewBoolValue(newValue));
+
+  if (command == m_pCompressionCmd || command == m_pBasketSizeCmd)
+    {
+      G4String hName;
+      G4int iValue;
+      std::istringstream hStream(newValue);
+      hStream >> hName >> iValue;
+
+      if (command == m_pCompressionCmd)
+        m_pAnalysisManager->SetCompression(hName, iValue);
+      else
+        m_pAnalysisManager->AddBasketSize(hName, iValue);
+    }
+
+  if (command == m_pAutoFlushCmd)
+    m_pAnalysisManager->SetAutoFlush(m_pAutoFlushCmd->GetNewIntValue(newValue));
+
+  if (command == m_pPresetCmd)
+    m_pAnalysisManager->SetOutputPreset(newValue);
+
+  if (command == m_pKeepCmd)
+    m_pAnalysisManager->KeepBranches(newValue);
+
+  if (command == m_pDropCmd)
+    m_pAnalysisManager->DropBranches(newValue);
+
+  if (command == m_pProfileCmd)
+    m_pAnalysisManager->SetBranchProfile(newValue);
+
+  if (command == m_pWriteEmptyCmd)
+    m_pAnalysisManager->SetWriteEmptyEvents(m_pWriteEmptyCmd->GetNewBoolValue(newValue));
+
+  if (command == m_pPhaseSpaceVolumeCmd)
+    m_pAnalysisManager->SetPhaseSpaceVolume(newValue);
+
+  if (command == m_pPhaseSpaceStopCmd)
+    m_pAnalysisManager->SetPhaseSpaceStop(m_pPhaseSpaceStopCmd->GetNewBoolValue(newValue));
+
+  if (command == m_pPhaseSpaceParticlesCmd)
+    m_pAnalysisManager->SetPhaseSpaceParticles(newValue);
+
+  if (command == m_pEnergyBinningCmd)
+    {
+      G4int iNbBins;
+      G4double dEnergyMax;
+      G4String hUnit;
+      std::istringstream hStream(newValue);
+      hStream >> iNbBins >> dEnergyMax >> hUnit;
+      m_pAnalysisManager->SetHistogramEnergyBinning(iNbBins, dEnergyMax*G4UIcommand::ValueOf(hUnit));
+    }
+}
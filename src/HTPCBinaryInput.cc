@@ -0,0 +1,101 @@
+#include "HTPCBinaryInput.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+
+HTPCBinaryInput::HTPCBinaryInput()
+    : m_pData(0),
+      m_iSize(0),
+      m_iStart(0),
+      m_iPosition(0),
+      m_iPrefetchSize(0),
+      m_iPrefetched(0) {}
+
+HTPCBinaryInput::~HTPCBinaryInput() { Close(); }
+
+void HTPCBinaryInput::Open(const std::string &hFilename, const char *szMagic,
+                           size_t iPrefetchSize) {
+  Close();
+
+  int iFile = open(hFilename.c_str(), O_RDONLY);
+  if (iFile < 0)
+    throw std::runtime_error("HTPCBinaryInput: cannot open " + hFilename);
+
+  const size_t iStart = szMagic ? iMagicSize : 0;
+  struct stat hStat;
+  if (fstat(iFile, &hStat) != 0 || (size_t) hStat.st_size < iStart ||
+      hStat.st_size == 0) {
+    close(iFile);
+    throw std::runtime_error("HTPCBinaryInput: " + hFilename +
+                             " is too short");
+  }
+
+  void *pData = mmap(0, hStat.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+  close(iFile);
+  if (pData == MAP_FAILED)
+    throw std::runtime_error("HTPCBinaryInput: cannot map " + hFilename);
+
+  m_pData = static_cast<const char *>(pData);
+  m_iSize = hStat.st_size;
+  m_iStart = iStart;
+  m_hFilename = hFilename;
+
+  if (szMagic && std::memcmp(m_pData, szMagic, iMagicSize)) {
+    Close();
+    throw std::runtime_error("HTPCBinaryInput: " + hFilename + " is not a " +
+                             std::string(szMagic, iMagicSize) + " file");
+  }
+
+  madvise(pData, m_iSize, MADV_SEQUENTIAL);
+
+  const long iPageSize = sysconf(_SC_PAGESIZE);
+  m_iPrefetchSize = iPrefetchSize > (size_t) iPageSize ? iPrefetchSize
+                                                       : iPageSize;
+  Rewind();
+}
+
+void HTPCBinaryInput::Close() {
+  if (!m_pData) return;
+
+  munmap(const_cast<char *>(m_pData), m_iSize);
+  m_pData = 0;
+  m_iSize = m_iStart = m_iPosition = m_iPrefetched = 0;
+}
+
+bool HTPCBinaryInput::HasMagic(const std::string &hFilename,
+                               const char *szMagic) {
+  std::ifstream hFile(hFilename.c_str(), std::ios::binary);
+  char szFileMagic[iMagicSize];
+  return hFile.read(szFileMagic, iMagicSize) &&
+         !std::memcmp(szFileMagic, szMagic, iMagicSize);
+}
+
+void HTPCBinaryInput::Seek(size_t iPosition) {
+  if (iPosition > m_iSize)
+    throw std::runtime_error("HTPCBinaryInput: seek beyond the end of " +
+                             m_hFilename);
+
+  // pages behind the cursor or beyond the requested ones start a new window
+  if (iPosition < m_iPosition || iPosition > m_iPrefetched)
+    m_iPrefetched = iPosition;
+  m_iPosition = iPosition;
+  if (m_iPosition + m_iPrefetchSize / 2 > m_iPrefetched &&
+      m_iPrefetched < m_iSize)
+    Prefetch();
+}
+
+void HTPCBinaryInput::Prefetch() {
+  // page aligned window ahead of the cursor
+  const size_t iPageSize = sysconf(_SC_PAGESIZE);
+  size_t iBegin = std::max(m_iPrefetched, m_iPosition) / iPageSize * iPageSize;
+  size_t iEnd = std::min(m_iPosition + m_iPrefetchSize, m_iSize);
+  if (iEnd > iBegin)
+    madvise(const_cast<char *>(m_pData) + iBegin, iEnd - iBegin,
+            MADV_WILLNEED);
+  m_iPrefetched = iEnd;
+}
@@ -0,0 +1,52 @@
+#include "HTPCBufferedFile.hh"
+
+#include <stdexcept>
+
+HTPCBufferedFile::HTPCBufferedFile(const std::string &hOwner)
+    : m_hOwner(hOwner), m_iBufferSize(0) {}
+
+HTPCBufferedFile::~HTPCBufferedFile() {
+  try {
+    Close();
+  } catch (const std::exception &) {
+  }
+}
+
+void HTPCBufferedFile::Open(const std::string &hFilename,
+                            size_t iBufferSize) {
+  Close();
+
+  m_hFile.open(hFilename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!m_hFile)
+    throw std::runtime_error(m_hOwner + ": cannot open " + hFilename);
+
+  m_hFilename = hFilename;
+  m_iBufferSize = iBufferSize ? iBufferSize : 1;
+  m_hBuffer.clear();
+  m_hBuffer.reserve(m_iBufferSize + 64);
+}
+
+void HTPCBufferedFile::Write(const void *pData, size_t iNbBytes) {
+  const char *pBytes = static_cast<const char *>(pData);
+  m_hBuffer.insert(m_hBuffer.end(), pBytes, pBytes + iNbBytes);
+
+  if (m_hBuffer.size() >= m_iBufferSize) Flush();
+}
+
+void HTPCBufferedFile::Flush() {
+  if (m_hBuffer.empty()) return;
+
+  m_hFile.write(&m_hBuffer[0], m_hBuffer.size());
+  m_hBuffer.clear();
+  if (!m_hFile)
+    throw std::runtime_error(m_hOwner + ": cannot write " + m_hFilename);
+}
+
+void HTPCBufferedFile::Close() {
+  if (!m_hFile.is_open()) return;
+
+  Flush();
+  m_hFile.close();
+  if (!m_hFile)
+    throw std::runtime_error(m_hOwner + ": cannot write " + m_hFilename);
+}
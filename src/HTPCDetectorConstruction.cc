@@ -7,6 +7,7 @@
 #include <G4PVPlacement.hh>
 #include <G4SDManager.hh>
 #include <G4SubtractionSolid.hh>
+#include <G4MultiUnion.hh>
 #include <G4ThreeVector.hh>
 #include <G4RotationMatrix.hh>
 #include <G4VisAttributes.hh>
@@ -32,7 +33,10 @@ using std::max;
 //#include "PurdueDetectorMessenger.hh"-> To be updated still
 #include "HTPCSensitiveDetector.hh"
 #include "HTPCDetectorConstruction.hh"
+#include "HTPCPMTPacking.hh"
 #include "G4PhysicalVolumeStore.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
 
 map<G4String, G4double> HTPCDetectorConstruction::m_hGeometryParameters;
 
@@ -107,6 +111,62 @@ void HTPCDetectorConstruction::ApplyMessengers() {
     GXeActive_Alpha      = 0.5;
     LXeActive_Alpha      = 0.5;
     Sapphire_Alpha       = 0.7;
+
+    fMessengerGeometry = new G4GenericMessenger(this,
+                                        "/htpc/geometry/",
+                                        "Geometry options (pre-init only)");
+
+    fMessengerGeometry->DeclareProperty("detailLevel",
+                                m_hGeometryDetailLevel,
+                                "full: as-built geometry; simplified: homogenised "
+                                "PMT arrays and single-solid cryostats for "
+                                "far-field gamma transport")
+                      .SetCandidates("full simplified")
+                      .SetStates(G4State_PreInit);
+
+    fMessengerGeometry->DeclareProperty("pmtLayout",
+                                m_hPMTLayout,
+                                "PMT array layout: hex, rings or file "
+                                "(x,y per line in mm, see pmtLayoutFile)")
+                      .SetCandidates("hex rings file")
+                      .SetStates(G4State_PreInit);
+
+    fMessengerGeometry->DeclareProperty("pmtLayoutFile",
+                                m_hPMTLayoutFile,
+                                "CSV file with the PMT positions for pmtLayout file")
+                      .SetStates(G4State_PreInit);
+
+    fMessengerGeometry->DeclarePropertyWithUnit("pmtPitch",
+                                "mm",
+                                m_dPMTPitch,
+                                "Centre-to-centre PMT distance")
+                      .SetStates(G4State_PreInit);
+
+    fMessengerGeometry->DeclarePropertyWithUnit("pmtFootprint",
+                                "mm",
+                                m_dPMTFootprint,
+                                "PMT diameter that has to fit inside the array radius")
+                      .SetStates(G4State_PreInit);
+
+    fMessengerGeometry->DeclarePropertyWithUnit("pmtArrayRadius",
+                                "mm",
+                                m_dPMTArrayRadius,
+                                "Radius available to the PMT arrays (0: TPC radius)")
+                      .SetStates(G4State_PreInit);
+
+    fMessengerGeometry->DeclareProperty("pmtNumber",
+                                m_iNbPMTsRequested,
+                                "Number of PMTs per array (0: as many as fit)")
+                      .SetStates(G4State_PreInit);
+
+    m_hGeometryDetailLevel = "full";
+    m_hPMTLayout           = "hex";
+    m_hPMTLayoutFile       = "";
+    m_dPMTPitch            = 81. *mm;
+    m_dPMTFootprint        = 76.2 *mm;
+    m_dPMTOuterDiameter    = 77.5 *mm;
+    m_dPMTArrayRadius      = 0.;
+    m_iNbPMTsRequested     = 1184;
 }
 
 void HTPCDetectorConstruction::DefineGeometryParameters()
@@ -173,7 +233,8 @@ void HTPCDetectorConstruction::DefineGeometryParameters()
     m_hGeometryParameters["GasGap_H"]   = 5. *mm;
     m_hGeometryParameters["CathodeGap"] = 50. *mm;
     
-    m_hGeometryParameters["i_NbPMTS"] = 1184;
+    // Number of PMTs per array, updated once the layout has been generated
+    m_hGeometryParameters["i_NbPMTS"] = m_iNbPMTsRequested;
 
 }
 
@@ -442,17 +503,42 @@ namespace {
                         G4double Rmin,
                         G4double thickness,
                         G4double zpos);
+
+    // Flange or support ring on a simplified capsule (thickness is a half-length,
+    // as in AddFlange)
+    struct SimplifiedFlange {
+        G4double Rmax;
+        G4double thickness;
+        G4double zpos;
+    };
+
+    // Builds the capsule as a single polycone: the domes are replaced by
+    // cylindrical extensions of equal volume and the flanges become steps in
+    // the outer radius (wheredome = 0 (bottom), 1 (top), 2 (both))
+    G4VSolid* BuildSimplifiedCapsule(G4double Rmax,
+                                     G4double Dz,
+                                     G4double DomeCurve,
+                                     G4int    whereDome,
+                                     const vector<SimplifiedFlange>& flanges);
+
+    // Adds the mass of every material in a logical volume tree, by material name
+    void AccumulateMaterialMasses(G4LogicalVolume* pLogicalVolume,
+                                  map<G4String, G4double>& hMasses);
 }
 
 
 G4VPhysicalVolume* HTPCDetectorConstruction::Construct()
 {
+    G4cout << "HTPCDetectorConstruction: geometry detail level [ "
+           << m_hGeometryDetailLevel << " ]" << G4endl;
+
     DefineMaterials();
     DefineGeometryParameters();
     ConstructLab();
     ConstructCryostats();
     ConstructMedia();
     ConstructTPC();
+    DefineRegions();
 
     return phys_Lab;
 }
@@ -519,47 +605,66 @@ void HTPCDetectorConstruction::ConstructCryostats()
     G4double sRingExtension = GetGeometryParameter("sRingExtension");
     G4double sRingThickness = GetGeometryParameter("sRingThickness");
     
-    auto solidCapsule1 = BuildCapsule(
-        oCryostat_oD/2,
-        0.,
-        oCryostat_H/2, 
-        curveLength
-    );
+    G4VSolid* solid_oCryostat = nullptr;
+    if (m_hGeometryDetailLevel == "simplified") {
+        vector<SimplifiedFlange> oFlanges = {
+            {oCryostat_oD/2 + oFlangeExtension, oFlangeThickness, oFlangeHeight},
+            {oCryostat_oD/2 + sRingExtension, sRingThickness, -0.5*oCryostat_H/2},
+            {oCryostat_oD/2 + sRingExtension, sRingThickness, 0},
+            {oCryostat_oD/2 + sRingExtension, sRingThickness, 0.5*oCryostat_H/2}
+        };
+
+        solid_oCryostat = BuildSimplifiedCapsule(
+            oCryostat_oD/2,
+            oCryostat_H/2,
+            curveLength,
+            2,
+            oFlanges
+        );
+    }
+    else {
+        auto solidCapsule1 = BuildCapsule(
+            oCryostat_oD/2,
+            0.,
+            oCryostat_H/2, 
+            curveLength
+        );
 
-    auto oCryostat_Temp1 = AddFlange(
-        solidCapsule1, 
-        oCryostat_oD/2 + oFlangeExtension, 
-        oCryostat_oD/2, 
-        oFlangeThickness,
-        oFlangeHeight
-    );
+        auto oCryostat_Temp1 = AddFlange(
+            solidCapsule1, 
+            oCryostat_oD/2 + oFlangeExtension, 
+            oCryostat_oD/2, 
+            oFlangeThickness,
+            oFlangeHeight
+        );
 
-    // |__ Add bottom support ring
-    auto oCryostat_Temp2 = AddFlange(
-        oCryostat_Temp1, 
-        oCryostat_oD/2 + sRingExtension, 
-        oCryostat_oD/2, 
-        sRingThickness,
-        -0.5*oCryostat_H/2
-    );
+        // |__ Add bottom support ring
+        auto oCryostat_Temp2 = AddFlange(
+            oCryostat_Temp1, 
+            oCryostat_oD/2 + sRingExtension, 
+            oCryostat_oD/2, 
+            sRingThickness,
+            -0.5*oCryostat_H/2
+        );
 
-    // _|_ Add middle support ring
-    auto oCryostat_Temp3 = AddFlange(
-        oCryostat_Temp2, 
-        oCryostat_oD/2 + sRingExtension, 
-        oCryostat_oD/2, 
-        sRingThickness,
-        0
-    );
+        // _|_ Add middle support ring
+        auto oCryostat_Temp3 = AddFlange(
+            oCryostat_Temp2, 
+            oCryostat_oD/2 + sRingExtension, 
+            oCryostat_oD/2, 
+            sRingThickness,
+            0
+        );
 
-    // __| Add top support ring
-    auto solid_oCryostat = AddFlange(
-        oCryostat_Temp3, 
-        oCryostat_oD/2 + sRingExtension, 
-        oCryostat_oD/2, 
-        sRingThickness,
-        0.5*oCryostat_H/2
-    );
+        // __| Add top support ring
+        solid_oCryostat = AddFlange(
+            oCryostat_Temp3, 
+            oCryostat_oD/2 + sRingExtension, 
+            oCryostat_oD/2, 
+            sRingThickness,
+            0.5*oCryostat_H/2
+        );
+    }
 
     logic_oCryostat = new G4LogicalVolume(
         solid_oCryostat,
@@ -589,12 +694,24 @@ void HTPCDetectorConstruction::ConstructCryostats()
     logic_oCryostat->SetVisAttributes(vis_oCryostat);
 
     // ----- CryostatVacuum ---------------------------------------------------
-    auto solid_CryostatVacuum = BuildCapsule(
-        oCryostat_oD/2 - oCryostatWall_thickness, 
-        0.*m, 
-        oCryostat_H/2 , 
-        curveLength
-    );
+    G4VSolid* solid_CryostatVacuum = nullptr;
+    if (m_hGeometryDetailLevel == "simplified") {
+        solid_CryostatVacuum = BuildSimplifiedCapsule(
+            oCryostat_oD/2 - oCryostatWall_thickness,
+            oCryostat_H/2,
+            curveLength,
+            2,
+            vector<SimplifiedFlange>()
+        );
+    }
+    else {
+        solid_CryostatVacuum = BuildCapsule(
+            oCryostat_oD/2 - oCryostatWall_thickness, 
+            0.*m, 
+            oCryostat_H/2 , 
+            curveLength
+        );
+    }
 
     logic_CryostatVacuum = new G4LogicalVolume(
         solid_CryostatVacuum,
@@ -632,47 +749,66 @@ void HTPCDetectorConstruction::ConstructCryostats()
 
     G4double iFlangeHeight = iFlangeRelativeHeight*iCryostat_H/2;
     
-    auto solidCapsule2 = BuildCapsule(
-        iCryostat_oD/2,
-        0.,
-        iCryostat_H/2, 
-        curveLength
-    );
+    G4VSolid* solid_iCryostat = nullptr;
+    if (m_hGeometryDetailLevel == "simplified") {
+        vector<SimplifiedFlange> iFlanges = {
+            {iCryostat_oD/2 + iFlangeExtension, iFlangeThickness, iFlangeHeight},
+            {iCryostat_oD/2 + sRingExtension, sRingThickness, -0.5*iCryostat_H/2},
+            {iCryostat_oD/2 + sRingExtension, sRingThickness, 0},
+            {iCryostat_oD/2 + sRingExtension, sRingThickness, 0.5*iCryostat_H/2}
+        };
+
+        solid_iCryostat = BuildSimplifiedCapsule(
+            iCryostat_oD/2,
+            iCryostat_H/2,
+            curveLength,
+            2,
+            iFlanges
+        );
+    }
+    else {
+        auto solidCapsule2 = BuildCapsule(
+            iCryostat_oD/2,
+            0.,
+            iCryostat_H/2, 
+            curveLength
+        );
 
-    auto iCryostat_Temp1 = AddFlange(
-        solidCapsule2, 
-        iCryostat_oD/2 + iFlangeExtension, 
-        iCryostat_oD/2, 
-        iFlangeThickness, 
-        iFlangeHeight
-    );
+        auto iCryostat_Temp1 = AddFlange(
+            solidCapsule2, 
+            iCryostat_oD/2 + iFlangeExtension, 
+            iCryostat_oD/2, 
+            iFlangeThickness, 
+            iFlangeHeight
+        );
 
-    // |__ Add bottom support ring
-    auto iCryostat_Temp2 = AddFlange(
-        iCryostat_Temp1, 
-        iCryostat_oD/2 + sRingExtension, 
-        iCryostat_oD/2, 
-        sRingThickness,
-        -0.5*iCryostat_H/2
-    );
+        // |__ Add bottom support ring
+        auto iCryostat_Temp2 = AddFlange(
+            iCryostat_Temp1, 
+            iCryostat_oD/2 + sRingExtension, 
+            iCryostat_oD/2, 
+            sRingThickness,
+            -0.5*iCryostat_H/2
+        );
 
-    // _|_ Add middle support ring
-    auto iCryostat_Temp3 = AddFlange(
-        iCryostat_Temp2, 
-        iCryostat_oD/2 + sRingExtension, 
-        iCryostat_oD/2, 
-        sRingThickness,
-        0
-    );
+        // _|_ Add middle support ring
+        auto iCryostat_Temp3 = AddFlange(
+            iCryostat_Temp2, 
+            iCryostat_oD/2 + sRingExtension, 
+            iCryostat_oD/2, 
+            sRingThickness,
+            0
+        );
 
-    // __| Add top support ring
-    auto solid_iCryostat = AddFlange(
-        iCryostat_Temp3, 
-        iCryostat_oD/2 + sRingExtension, 
-        iCryostat_oD/2, 
-        sRingThickness,
-        0.5*iCryostat_H/2
-    );
+        // __| Add top support ring
+        solid_iCryostat = AddFlange(
+            iCryostat_Temp3, 
+            iCryostat_oD/2 + sRingExtension, 
+            iCryostat_oD/2, 
+            sRingThickness,
+            0.5*iCryostat_H/2
+        );
+    }
 
     logic_iCryostat = new G4LogicalVolume(
         solid_iCryostat,
@@ -721,12 +857,24 @@ void HTPCDetectorConstruction::ConstructMedia()
     G4double GXeMedium_oD = iCryostat_oD - 2*iCryostatWall_thickness;
     G4double GXeMedium_H  = iCryostat_H * (1-LiquidGasRatio);
 
-    auto solid_GXeMedium = BuildHalfCapsule(
-        GXeMedium_oD/2, 
-        GXeMedium_H/2, 
-        curveLength, 
-        1 // 'top'
-    );
+    G4VSolid* solid_GXeMedium = nullptr;
+    if (m_hGeometryDetailLevel == "simplified") {
+        solid_GXeMedium = BuildSimplifiedCapsule(
+            GXeMedium_oD/2,
+            GXeMedium_H/2,
+            curveLength,
+            1, // 'top'
+            vector<SimplifiedFlange>()
+        );
+    }
+    else {
+        solid_GXeMedium = BuildHalfCapsule(
+            GXeMedium_oD/2, 
+            GXeMedium_H/2, 
+            curveLength, 
+            1 // 'top'
+        );
+    }
 
     logic_GXeMedium = new G4LogicalVolume(
         solid_GXeMedium,
@@ -758,12 +906,24 @@ void HTPCDetectorConstruction::ConstructMedia()
     G4double LXeMedium_oD = iCryostat_oD - 2*iCryostatWall_thickness;
     G4double LXeMedium_H  = iCryostat_H * LiquidGasRatio;
 
-    auto solid_LXeMedium = BuildHalfCapsule(
-        LXeMedium_oD/2, 
-        LXeMedium_H/2, 
-        curveLength, 
-        0 // 'bottom'
-    );
+    G4VSolid* solid_LXeMedium = nullptr;
+    if (m_hGeometryDetailLevel == "simplified") {
+        solid_LXeMedium = BuildSimplifiedCapsule(
+            LXeMedium_oD/2,
+            LXeMedium_H/2,
+            curveLength,
+            0, // 'bottom'
+            vector<SimplifiedFlange>()
+        );
+    }
+    else {
+        solid_LXeMedium = BuildHalfCapsule(
+            LXeMedium_oD/2, 
+            LXeMedium_H/2, 
+            curveLength, 
+            0 // 'bottom'
+        );
+    }
 
     logic_LXeMedium = new G4LogicalVolume(
         solid_LXeMedium,
@@ -990,6 +1150,12 @@ void HTPCDetectorConstruction::ConstructTPC()
         true
     );
 
+    // liquid surface (top of LXeActive) in the world frame, the gate for the
+    // drift time of the signal stage
+    G4double LXeMedium_H = iCryostat_H * LiquidGasRatio;
+    m_hGeometryParameters["LiquidLevel_Z"] = -((iCryostat_H/2) - LXeMedium_H/2)
+        + z_LXeTeflonTub + LXeTeflonTub_H/2;
+
     // Defining LXeActive as a sensitive detector
     G4SDManager *pSDManager = G4SDManager::GetSDMpointer();
     LXeSensDet = new HTPCSensitiveDetector("LXeSensDet");
@@ -1149,42 +1315,61 @@ void HTPCDetectorConstruction::ConstructTPC()
     ResetPMTCache(); 
     
     // Construct Top PMT array
-    G4int iNbPMTs = GetGeometryParameter("i_NbPMTS");
+    G4int iNbPMTs = GetPMTPositions().size();
     G4double dPMTOffsetZTop = -(iCryostat_H/2) * (1-LiquidGasRatio) 
                               + GXeTeflonTub_H 
                               + dPMTHeight/2;
 
-    m_pPmtR11410LogicalVolume = ConstructPMT();
-    for (G4int iPMT = 0; iPMT < iNbPMTs; ++iPMT) {
-        hVolumeName.str("");
-        hVolumeName << "PmtTpcTop_" << iPMT;
-        G4ThreeVector PmtPosition = GetPMTPosition(iPMT, iNbPMTs);
-        m_pPMTPhysicalVolumes.push_back(new G4PVPlacement(0,
-                              PmtPosition+G4ThreeVector(0., 0., dPMTOffsetZTop),
-                             m_pPmtR11410LogicalVolume, hVolumeName.str(),
-                             logic_GXeMedium, false, iPMT));
-    }
-    G4cout<<"Top Array Constructed"<<G4endl;
-    
-    // Construct Bottom PMT array
     G4double dPMTOffsetZBot = (iCryostat_H/2) * LiquidGasRatio 
                               - LXeTeflonTub_H 
                               - dPMTHeight/2;
-    
-    G4RotationMatrix *pRotX180 = new G4RotationMatrix();
-    pRotX180->rotateX(180. * deg);
-
-    for (G4int iPMT = 0; iPMT < iNbPMTs; ++iPMT) {
-        G4ThreeVector PmtPosition = GetPMTPosition(iPMT, iNbPMTs);
-        G4int iPMT_label = iPMT + iNbPMTs;
-        hVolumeName.str("");
-        hVolumeName << "PmtTpcTop_" << iPMT_label;
-        m_pPMTPhysicalVolumes.push_back(new G4PVPlacement(pRotX180,
-                              PmtPosition+G4ThreeVector(0., 0., dPMTOffsetZBot),
-                              m_pPmtR11410LogicalVolume, hVolumeName.str(),
-                              logic_LXeMedium, false, iPMT_label));
+
+    m_pPmtR11410LogicalVolume = ConstructPMT();
+    if (m_hGeometryDetailLevel == "simplified") {
+        m_pPMTPhysicalVolumes.push_back(ConstructPMTArraySlab(
+            "PmtTpcTop_ArrayTop",
+            logic_GXeMedium,
+            dPMTOffsetZTop,
+            dPMTHeight,
+            iNbPMTs,
+            0));
+        m_pPMTPhysicalVolumes.push_back(ConstructPMTArraySlab(
+            "PmtTpcTop_ArrayBottom",
+            logic_LXeMedium,
+            dPMTOffsetZBot,
+            dPMTHeight,
+            iNbPMTs,
+            1));
+        G4cout<<"Homogenised PMT arrays constructed"<<G4endl;
+    }
+    else {
+        for (G4int iPMT = 0; iPMT < iNbPMTs; ++iPMT) {
+            hVolumeName.str("");
+            hVolumeName << "PmtTpcTop_" << iPMT;
+            G4ThreeVector PmtPosition = GetPMTPosition(iPMT);
+            m_pPMTPhysicalVolumes.push_back(new G4PVPlacement(0,
+                                  PmtPosition+G4ThreeVector(0., 0., dPMTOffsetZTop),
+                                 m_pPmtR11410LogicalVolume, hVolumeName.str(),
+                                 logic_GXeMedium, false, iPMT));
+        }
+        G4cout<<"Top Array Constructed"<<G4endl;
+
+        // Construct Bottom PMT array
+        G4RotationMatrix *pRotX180 = new G4RotationMatrix();
+        pRotX180->rotateX(180. * deg);
+
+        for (G4int iPMT = 0; iPMT < iNbPMTs; ++iPMT) {
+            G4ThreeVector PmtPosition = GetPMTPosition(iPMT);
+            G4int iPMT_label = iPMT + iNbPMTs;
+            hVolumeName.str("");
+            hVolumeName << "PmtTpcTop_" << iPMT_label;
+            m_pPMTPhysicalVolumes.push_back(new G4PVPlacement(pRotX180,
+                                  PmtPosition+G4ThreeVector(0., 0., dPMTOffsetZBot),
+                                  m_pPmtR11410LogicalVolume, hVolumeName.str(),
+                                  logic_LXeMedium, false, iPMT_label));
+        }
+        G4cout<<"Bottom Array Constructed"<<G4endl;
     }
-    G4cout<<"Bottom Array Constructed"<<G4endl;
     
 
     // ---- Copper Support Plates---------------------------------------------
@@ -1206,34 +1391,54 @@ void HTPCDetectorConstruction::ConstructTPC()
         CopperPlate_Thickness/ 2.0,
         0.0,
         360.0 * deg); 
-    //For now ignore holes in PMT Support PLate
-    /*
-    G4VSolid* solid_CopperPlate = solid_Plate;
-    
-    // Subtract PMT Ho;es
-    for (G4int iPMT = 0; iPMT < iNbPMTs; ++iPMT)
-    {
-        G4String name = "PMTHole_" + std::to_string(iPMT);
 
-        G4Tubs* holeSolid = new G4Tubs(
-            name,
+    G4VSolid* solid_CopperPlate = solid_Plate;
+    G4Material* pTopPlateMaterial = Copper;
+    G4Material* pBotPlateMaterial = Copper;
+    if (m_hGeometryDetailLevel == "simplified") {
+        // plain discs of copper and the medium filling the holes, same mass
+        G4double dHolesVolume = iNbPMTs * M_PI * pow(PmtHole_oD/2., 2) * CopperPlate_Thickness;
+        pTopPlateMaterial = BuildPerforatedPlateMaterial(
+            "PerforatedCopper_" + logic_GXeMedium->GetMaterial()->GetName(),
+            Copper,
+            logic_GXeMedium->GetMaterial(),
+            solid_Plate->GetCubicVolume(),
+            dHolesVolume);
+        pBotPlateMaterial = BuildPerforatedPlateMaterial(
+            "PerforatedCopper_" + logic_LXeMedium->GetMaterial()->GetName(),
+            Copper,
+            logic_LXeMedium->GetMaterial(),
+            solid_Plate->GetCubicVolume(),
+            dHolesVolume);
+    }
+    else {
+        // PMT holes: one voxelised G4MultiUnion of all hole cylinders, subtracted
+        // once, so navigation does not scale with the number of holes
+        G4Tubs* solid_PmtHole = new G4Tubs(
+            "solid_PmtHole",
             0.0,
             PmtHole_oD/2.,
-            CopperPlate_Thickness/2.,
+            CopperPlate_Thickness/2. + kTol,
             0.0,
             360.0 * deg);
 
-        G4ThreeVector PmtPosition = GetPMTPosition(iPMT, iNbPMTs);
-        solid_CopperPlate = new G4SubtractionSolid("solid_CopperPlate_" + std::to_string(iPMT),
-                                   solid_CopperPlate,
-                                   holeSolid,
-                                   nullptr,
-                                   PmtPosition);
+        G4MultiUnion* solid_PmtHoles = new G4MultiUnion("solid_PmtHoles");
+        for (G4int iPMT = 0; iPMT < iNbPMTs; ++iPMT)
+        {
+            G4Transform3D hHoleTransform(G4RotationMatrix(), GetPMTPosition(iPMT));
+            solid_PmtHoles->AddNode(*solid_PmtHole, hHoleTransform);
+        }
+        solid_PmtHoles->Voxelize();
+
+        solid_CopperPlate = new G4SubtractionSolid(
+            "solid_CopperPlate",
+            solid_Plate,
+            solid_PmtHoles);
     }
-    */
+
     logic_TopCopperPlate = new G4LogicalVolume(
-        solid_Plate,
-        Copper,
+        solid_CopperPlate,
+        pTopPlateMaterial,
         "logic_TopCopperPlate");
     
     phys_TopCopperPlate = new G4PVPlacement(
@@ -1246,8 +1451,8 @@ void HTPCDetectorConstruction::ConstructTPC()
                   0);
     
     logic_BotCopperPlate = new G4LogicalVolume(
-        solid_Plate,
-        Copper,
+        solid_CopperPlate,
+        pBotPlateMaterial,
         "logic_BotCopperPlate");
     
     phys_BotCopperPlate = new G4PVPlacement(
@@ -1267,6 +1472,26 @@ void HTPCDetectorConstruction::ConstructTPC()
 }
 
 
+// ---------------------------------------------------------------------------
+
+void HTPCDetectorConstruction::DefineRegions()
+{
+    // Detector zones for production cuts and EM models (see HTPCPhysicsList).
+    // A region propagates down the volume tree until it reaches the root of
+    // another region, the Lab stays in the default world region.
+    G4RegionStore* pRegionStore = G4RegionStore::GetInstance();
+
+    G4Region* pShield = pRegionStore->FindOrCreateRegion("Shield");
+    pShield->AddRootLogicalVolume(logic_oCryostat);
+
+    G4Region* pInnerDetector = pRegionStore->FindOrCreateRegion("InnerDetector");
+    pInnerDetector->AddRootLogicalVolume(logic_iCryostat);
+
+    G4Region* pActiveXe = pRegionStore->FindOrCreateRegion("ActiveXe");
+    pActiveXe->AddRootLogicalVolume(logic_LXeActive);
+    pActiveXe->AddRootLogicalVolume(logic_GXeActive);
+}
+
 // ---------------------------------------------------------------------------
 
 
@@ -1275,7 +1500,7 @@ G4LogicalVolume *HTPCDetectorConstruction::ConstructPMT() {
   G4double dPMTOuterRadius      = 38. * mm;
   G4double dPMTOuterRingBottomZ = 9. * mm;
   G4double dPMTOuterRingHeight  = 5. * mm;
-  G4double dPMTOuterRingRadius  = 38.75 * mm;
+  G4double dPMTOuterRingRadius  = m_dPMTOuterDiameter / 2.;
 
   G4double dPMTWindowRadius    = 35. * mm;
   G4double dPMTWindowThickness = 3.5 * mm;
@@ -1598,10 +1823,11 @@ G4LogicalVolume *HTPCDetectorConstruction::ConstructPMT() {
   return m_pPMTLogicalVolume;
 }
 
-G4double HTPCDetectorConstruction::GetGeometryParameter(const char *szParameter)
+G4double HTPCDetectorConstruction::GetGeometryParameter(const char *szParameter) const
 {
-  if (m_hGeometryParameters.find(szParameter) != m_hGeometryParameters.end()){
-    return m_hGeometryParameters[szParameter];
+  map<G4String, G4double>::const_iterator pIt = m_hGeometryParameters.find(szParameter);
+  if (pIt != m_hGeometryParameters.end()){
+    return pIt->second;
   }
   else {
     G4cout<< "Parameter: " << szParameter << " is not defined!!!!!" << G4endl;
@@ -1609,90 +1835,207 @@ G4double HTPCDetectorConstruction::GetGeometryParameter(const char *szParameter)
   }
 }
 
-G4ThreeVector HTPCDetectorConstruction::GetPMTPosition(G4int index, G4int i_nmbPMTS)
+const vector<G4ThreeVector> &HTPCDetectorConstruction::GetPMTPositions()
 {
-    if (index < 0 || index >= i_nmbPMTS) {
-        throw std::out_of_range("Index must be between 0 and number of PMTs");
-    }
-    
-    // -----------------------------------------------------------
-
-    if (!fPMTCacheInitialized || fCachedPMTCount != i_nmbPMTS)
+    if (!fPMTCacheInitialized)
     {
-        fCachedPMTPositions.clear();
-        fCachedPMTPositions.reserve(i_nmbPMTS);
-
-        fCachedPMTCount = i_nmbPMTS;
-
-        G4double outer_radius = GetGeometryParameter("TPC_oD") / 2.0; // Container radius
-        const G4double circle_diameter        = 0.0762 * m;
-        const G4double circle_radius_physical = circle_diameter / 2.0;
-        const G4double spacing_diameter = 0.081 * m;   
-        const G4double spacing_radius   = spacing_diameter / 2.0;
-        const G4double dy               = spacing_radius * std::sqrt(3.0); //Vertical row spacing
-
-        G4double y = -outer_radius;
-        int row = 0;
-        int current_index = 0;
-
-        while (y <= outer_radius && current_index < i_nmbPMTS)
-        {
-            G4double x_offset = (row % 2 == 0 ? 0.0 : spacing_radius);
-            G4double x = -outer_radius + x_offset;
-
-            while (x <= outer_radius && current_index < i_nmbPMTS)
-            {
-                G4double dist_to_center = std::sqrt(x*x + y*y);
-
-                // PMT fits inside tank if its physical radius fits
-                if (dist_to_center + circle_radius_physical <= outer_radius)
-                {
-                    fCachedPMTPositions.emplace_back(x, y, 0.0);
-                    ++current_index;
-                }
-
-                x += 2.0 * spacing_radius;   
-            }
-
-            y += dy;
-            ++row;
+        G4double dArrayRadius = m_dPMTArrayRadius > 0. ? m_dPMTArrayRadius
+                                                       : GetGeometryParameter("TPC_oD") / 2.0;
+
+        auto hPositions = HTPCPMTPacking::Generate(
+            HTPCPMTPacking::ParseLayout(m_hPMTLayout),
+            dArrayRadius,
+            m_dPMTFootprint / 2.0,
+            m_dPMTPitch,
+            m_iNbPMTsRequested,
+            m_hPMTLayoutFile);
+
+        if (m_iNbPMTsRequested > 0 && (G4int)hPositions.size() != m_iNbPMTsRequested) {
+            throw std::runtime_error(
+                "GetPMTPositions: generated "
+                + std::to_string(hPositions.size()) +
+                " positions, but expected " + std::to_string(m_iNbPMTsRequested));
         }
 
-        if ((int)fCachedPMTPositions.size() != i_nmbPMTS) {
-            throw std::runtime_error(
-                "GetPMTPosition: generated "
-                + std::to_string(fCachedPMTPositions.size()) +
-                " positions, but expected " + std::to_string(i_nmbPMTS));
+        // PMTs closer than the diameter of their outer ring overlap
+        G4double dMinimumDistance = HTPCPMTPacking::MinimumDistance(hPositions);
+        if (hPositions.size() > 1 && dMinimumDistance < m_dPMTOuterDiameter) {
+            stringstream hMessage;
+            hMessage << "PMTs are only " << dMinimumDistance / mm
+                     << " mm apart and will overlap";
+            G4Exception("HTPCDetectorConstruction::GetPMTPositions()",
+                        "HTPCGeom0002", JustWarning, hMessage.str().c_str());
         }
 
-        // Find PMT closest to center
-        G4ThreeVector centroid(0,0,0);
-        for (auto &p : fCachedPMTPositions)
-            centroid += p;
-        centroid /= (G4double)fCachedPMTPositions.size();
+        fCachedPMTPositions.clear();
+        fCachedPMTPositions.reserve(hPositions.size());
+        for (const auto &hPosition : hPositions)
+            fCachedPMTPositions.emplace_back(hPosition.x, hPosition.y, 0.0);
+
+        m_hGeometryParameters["i_NbPMTS"] = fCachedPMTPositions.size();
+        fPMTCacheInitialized = true;
+
+        G4cout << "PMT layout [ " << m_hPMTLayout << " ]: "
+               << fCachedPMTPositions.size() << " PMTs per array" << G4endl;
+    }
 
-        // Compute shift
-        G4ThreeVector shift =  -centroid;
+    return fCachedPMTPositions;
+}
 
-        // Apply shift to all
-        for (auto &p : fCachedPMTPositions)
-            p += shift;
+G4ThreeVector HTPCDetectorConstruction::GetPMTPosition(G4int index)
+{
+    const vector<G4ThreeVector> &hPositions = GetPMTPositions();
 
-        fPMTCacheInitialized = true;
+    if (index < 0 || index >= (G4int)hPositions.size()) {
+        throw std::out_of_range("Index must be between 0 and number of PMTs");
     }
 
-    return fCachedPMTPositions[index];
+    return hPositions[index];
 }
 
 void HTPCDetectorConstruction::ResetPMTCache()
 {
     fPMTCacheInitialized = false;
-    fCachedPMTCount = -1;
     fCachedPMTPositions.clear();
     G4cout<<"PMT cache reset"<<G4endl;
     G4cout<<"PMT Cache size now "<<fCachedPMTPositions.size()<<G4endl;
 }
 
+G4Material *HTPCDetectorConstruction::BuildPMTArrayMaterial(const G4String &hName,
+                                                            G4Material *pMedium,
+                                                            G4double dSlabVolume,
+                                                            G4int iNbPMTs)
+{
+    // Mass of each material in one PMT, scaled to the whole array
+    map<G4String, G4double> hMasses;
+    AccumulateMaterialMasses(m_pPmtR11410LogicalVolume, hMasses);
+    for (auto &hMass : hMasses)
+        hMass.second *= iNbPMTs;
+
+    // The medium fills whatever the PMTs leave free in the slab
+    G4double dPMTVolume = iNbPMTs * m_pPmtR11410LogicalVolume->GetSolid()->GetCubicVolume();
+    if (dPMTVolume >= dSlabVolume) {
+        G4Exception("HTPCDetectorConstruction::BuildPMTArrayMaterial()",
+                    "HTPCGeom0001", FatalException,
+                    ("PMT array does not fit into slab " + hName).c_str());
+    }
+    hMasses[pMedium->GetName()] += (dSlabVolume - dPMTVolume) * pMedium->GetDensity();
+
+    G4double dTotalMass = 0.;
+    for (const auto &hMass : hMasses)
+        dTotalMass += hMass.second;
+
+    G4Material *pMaterial = new G4Material(
+        hName,
+        dTotalMass / dSlabVolume,
+        (G4int)hMasses.size(),
+        pMedium->GetState(),
+        pMedium->GetTemperature(),
+        pMedium->GetPressure()
+    );
+
+    for (const auto &hMass : hMasses)
+        pMaterial->AddMaterial(G4Material::GetMaterial(hMass.first),
+                               hMass.second / dTotalMass);
+
+    G4cout << "Homogenised PMT array material " << hName << ": "
+           << dTotalMass / kg << " kg, "
+           << pMaterial->GetDensity() / (g / cm3) << " g/cm3" << G4endl;
+
+    return pMaterial;
+}
+
+G4Material *HTPCDetectorConstruction::BuildPerforatedPlateMaterial(const G4String &hName,
+                                                                   G4Material *pPlate,
+                                                                   G4Material *pMedium,
+                                                                   G4double dPlateVolume,
+                                                                   G4double dHolesVolume)
+{
+    // The material of the plate with the medium filling its holes
+    G4Material *pMaterial = G4Material::GetMaterial(hName, false);
+    if (pMaterial)
+        return pMaterial;
+
+    if (dHolesVolume >= dPlateVolume) {
+        G4Exception("HTPCDetectorConstruction::BuildPerforatedPlateMaterial()",
+                    "HTPCGeom0003", FatalException,
+                    ("Holes do not fit into plate " + hName).c_str());
+    }
+
+    G4double dPlateMass = (dPlateVolume - dHolesVolume) * pPlate->GetDensity();
+    G4double dMediumMass = dHolesVolume * pMedium->GetDensity();
+    G4double dTotalMass = dPlateMass + dMediumMass;
+
+    pMaterial = new G4Material(
+        hName,
+        dTotalMass / dPlateVolume,
+        2,
+        pPlate->GetState(),
+        pMedium->GetTemperature()
+    );
+    pMaterial->AddMaterial(pPlate, dPlateMass / dTotalMass);
+    pMaterial->AddMaterial(pMedium, dMediumMass / dTotalMass);
+
+    G4cout << "Homogenised plate material " << hName << ": "
+           << dTotalMass / kg << " kg, "
+           << pMaterial->GetDensity() / (g / cm3) << " g/cm3" << G4endl;
+
+    return pMaterial;
+}
+
+G4VPhysicalVolume *HTPCDetectorConstruction::ConstructPMTArraySlab(const G4String &hName,
+                                                                   G4LogicalVolume *pMotherLogicalVolume,
+                                                                   G4double dOffsetZ,
+                                                                   G4double dPMTHeight,
+                                                                   G4int iNbPMTs,
+                                                                   G4int iCopyNo)
+{
+    // One disc covering the array footprint replaces the individual PMTs;
+    // the name keeps the PmtTpcTop_ prefix so source confinement still works
+    G4double TPC_oD = GetGeometryParameter("TPC_oD");
+
+    G4Tubs *solid_Slab = new G4Tubs(
+        "solid_" + hName,
+        0.,
+        TPC_oD/2,
+        dPMTHeight/2,
+        0.   *deg,
+        360. *deg
+    );
+
+    G4Material *pSlabMaterial = BuildPMTArrayMaterial(
+        "PMTArray_" + pMotherLogicalVolume->GetMaterial()->GetName(),
+        pMotherLogicalVolume->GetMaterial(),
+        solid_Slab->GetCubicVolume(),
+        iNbPMTs
+    );
+
+    G4LogicalVolume *logic_Slab = new G4LogicalVolume(
+        solid_Slab,
+        pSlabMaterial,
+        "logic_" + hName
+    );
+
+    G4VPhysicalVolume *phys_Slab = new G4PVPlacement(
+        0,
+        G4ThreeVector(0., 0., dOffsetZ),
+        logic_Slab,
+        hName,
+        pMotherLogicalVolume,
+        false,
+        iCopyNo,
+        true
+    );
+
+    G4Colour hPMTColor(1., 0.486, 0.027);
+    G4VisAttributes *pSlabVisAtt = new G4VisAttributes(hPMTColor);
+    pSlabVisAtt->SetVisibility(true);
+    pSlabVisAtt->SetForceSolid(true);
+    logic_Slab->SetVisAttributes(pSlabVisAtt);
+
+    return phys_Slab;
+}
+
 
 /* ----------------------------------------------------------------------- */
 
@@ -1949,4 +2292,85 @@ namespace {
         
         return solidCapsulewFlange;
     }
-}
\ No newline at end of file
+}
+
+
+namespace {
+    // Height of a cylinder of radius Rmax holding the same volume as the dome
+    // cap built by BuildCapsule / BuildHalfCapsule
+    G4double EquivalentDomeHeight(G4double Rmax, G4double DomeCurve) {
+        G4double SphR   = sqrt(pow(Rmax,2) + pow(DomeCurve,2));
+        G4double CapH   = SphR - DomeCurve;
+        G4double CapVol = M_PI * pow(CapH,2) * (3*SphR - CapH) / 3.;
+
+        return CapVol / (M_PI * pow(Rmax,2));
+    }
+
+    G4VSolid* BuildSimplifiedCapsule(
+        G4double Rmax,
+        G4double Dz,
+        G4double DomeCurve,
+        G4int    whereDome,
+        const vector<SimplifiedFlange>& flanges) {
+
+        G4double DomeH = EquivalentDomeHeight(Rmax, DomeCurve);
+        G4double zMin  = (whereDome == 0 || whereDome == 2) ? -Dz - DomeH : -Dz;
+        G4double zMax  = (whereDome == 1 || whereDome == 2) ?  Dz + DomeH :  Dz;
+
+        // Every flange edge splits the profile into sections of constant radius
+        vector<G4double> zEdges = {zMin, zMax};
+        for (const auto& flange : flanges) {
+            zEdges.push_back(std::min(zMax, std::max(zMin, flange.zpos - flange.thickness)));
+            zEdges.push_back(std::min(zMax, std::max(zMin, flange.zpos + flange.thickness)));
+        }
+        std::sort(zEdges.begin(), zEdges.end());
+        zEdges.erase(std::unique(zEdges.begin(), zEdges.end()), zEdges.end());
+
+        vector<G4double> zPlanes;
+        vector<G4double> rOuter;
+        for (size_t i = 0; i + 1 < zEdges.size(); ++i) {
+            G4double zMid = 0.5*(zEdges[i] + zEdges[i+1]);
+            G4double r    = Rmax;
+            for (const auto& flange : flanges) {
+                if (std::fabs(zMid - flange.zpos) < flange.thickness)
+                    r = std::max(r, flange.Rmax);
+            }
+
+            // Sections with the same radius are merged into one
+            if (!rOuter.empty() && rOuter.back() == r) {
+                zPlanes.back() = zEdges[i+1];
+                continue;
+            }
+            zPlanes.push_back(zEdges[i]);
+            rOuter.push_back(r);
+            zPlanes.push_back(zEdges[i+1]);
+            rOuter.push_back(r);
+        }
+        vector<G4double> rInner(zPlanes.size(), 0.);
+
+        return new G4Polycone(
+            "solidSimplifiedCapsule",
+            0.   *deg,
+            360. *deg,
+            (G4int)zPlanes.size(),
+            zPlanes.data(),
+            rInner.data(),
+            rOuter.data()
+        );
+    }
+
+    void AccumulateMaterialMasses(
+        G4LogicalVolume* pLogicalVolume,
+        map<G4String, G4double>& hMasses) {
+
+        G4double dVolume = pLogicalVolume->GetSolid()->GetCubicVolume();
+        for (size_t i = 0; i < pLogicalVolume->GetNoDaughters(); ++i) {
+            G4LogicalVolume* pDaughter = pLogicalVolume->GetDaughter(i)->GetLogicalVolume();
+            dVolume -= pDaughter->GetSolid()->GetCubicVolume();
+            AccumulateMaterialMasses(pDaughter, hMasses);
+        }
+
+        G4Material* pMaterial = pLogicalVolume->GetMaterial();
+        hMasses[pMaterial->GetName()] += dVolume * pMaterial->GetDensity();
+    }
+}
@@ -1,65 +1,14 @@
 #include "HTPCEventData.hh"
 
+#include <utility>
+
 HTPCEventData::HTPCEventData()
 {
-	m_iEventId = 0;
-
-	//Vind uit wat nodig is, verwys na Analysis Manager
-	m_iNbPMTHits = 0;
-	m_pPMTHits = new vector<int>;
-
-	m_fTotalEnergyDeposited = 0.;
-	m_iNbSteps = 0;
-
-	m_pTrackId = new vector<int>;
-	m_pParentId = new vector<int>;
-	m_pParticleType = new vector<string>;
-	m_pParentType = new vector<string>;
-	m_pCreatorProcess = new vector<string>;
-	m_pDepositingProcess = new vector<string>;
-	m_pX = new vector<float>;
-	m_pY = new vector<float>;
-	m_pZ = new vector<float>;
-	m_pEnergyDeposited = new vector<float>;
-	m_pKineticEnergy = new vector<float>;
-	m_pPreStepEnergy = new vector<float>;
-	m_pPostStepEnergy = new vector<float>;
-
-	m_pTime = new vector<float>;
-
-	m_pPrimaryParticleType = new vector<string>;
-	m_fPrimaryX = 0.;
-	m_fPrimaryY = 0.;
-	m_fPrimaryZ = 0.;
-	m_fForcedPrimaryX = 0.;
-	m_fForcedPrimaryY = 0.;
-	m_fForcedPrimaryZ = 0.;
-	m_fPrimaryCx = 0.;
-    m_fPrimaryCy = 0.;
-    m_fPrimaryCz = 0.;
-	m_fPrimaryE = 0.;
-
+	Clear();
 }
 
 HTPCEventData::~HTPCEventData()
 {
-	delete m_pPMTHits;
-	delete m_pTrackId;
-	delete m_pParentId;
-	delete m_pParticleType;
-	delete m_pParentType;
-	delete m_pCreatorProcess;
-	delete m_pDepositingProcess;
-	delete m_pX;
-	delete m_pY;
-	delete m_pZ;
-	delete m_pEnergyDeposited;
-	delete m_pKineticEnergy;
-	delete m_pPreStepEnergy;
- 	delete m_pPostStepEnergy;
-	delete m_pTime;
-
-	delete m_pPrimaryParticleType;
 }
 
 void HTPCEventData::Clear()
@@ -67,35 +16,122 @@ void HTPCEventData::Clear()
 	m_iEventId = 0;
 	m_iNbPMTHits = 0;
 
-	m_pPMTHits->clear();
+	m_hPMTHits.clear();
 
 	m_fTotalEnergyDeposited = 0.0;
 	m_iNbSteps = 0;
 
-	m_pTrackId->clear();
-	m_pParentId->clear();
-	m_pParticleType->clear();
-	m_pParentType->clear();
-	m_pCreatorProcess->clear();
-	m_pDepositingProcess->clear();
-	m_pX->clear();
-	m_pY->clear();
-	m_pZ->clear();
-	m_pEnergyDeposited->clear();
-	m_pKineticEnergy->clear();
-	m_pPreStepEnergy->clear();
- 	m_pPostStepEnergy->clear();
-
-	m_pTime->clear();
-
-	m_pPrimaryParticleType->clear();
+	m_hTrackId.clear();
+	m_hParentId.clear();
+	m_hParticleType.clear();
+	m_hParentType.clear();
+	m_hCreatorProcess.clear();
+	m_hDepositingProcess.clear();
+	m_hX.clear();
+	m_hY.clear();
+	m_hZ.clear();
+	m_hEnergyDeposited.clear();
+	m_hPreStepEnergy.clear();
+	m_hPostStepEnergy.clear();
+	m_hTime.clear();
+
+	m_hPrimaryParticleType.clear();
 	m_fPrimaryX = 0.;
 	m_fPrimaryY = 0.;
 	m_fPrimaryZ = 0.;
+	m_fForcedPrimaryX = 0.;
+	m_fForcedPrimaryY = 0.;
+	m_fForcedPrimaryZ = 0.;
 	m_fPrimaryE = 0.;
 	m_fPrimaryW = 0.;
     m_fPrimaryCx = 0.;
     m_fPrimaryCy = 0.;
     m_fPrimaryCz = 0.;
+
+	m_iNbClusters = 0;
+	m_hClusterEnergy.clear();
+	m_hClusterX.clear();
+	m_hClusterY.clear();
+	m_hClusterZ.clear();
+	m_hClusterNbPhotons.clear();
+	m_hClusterNbElectrons.clear();
+	m_hClusterDriftTime.clear();
+	m_hClusterS1.clear();
+	m_hClusterS2.clear();
+	m_fS1 = 0.;
+	m_fS2 = 0.;
 }
 
+void HTPCEventData::Swap(HTPCEventData &hOther)
+{
+	std::swap(m_iEventId, hOther.m_iEventId);
+	std::swap(m_iNbPMTHits, hOther.m_iNbPMTHits);
+	std::swap(m_fTotalEnergyDeposited, hOther.m_fTotalEnergyDeposited);
+	std::swap(m_iNbSteps, hOther.m_iNbSteps);
+	std::swap(m_fPrimaryX, hOther.m_fPrimaryX);
+	std::swap(m_fPrimaryY, hOther.m_fPrimaryY);
+	std::swap(m_fPrimaryZ, hOther.m_fPrimaryZ);
+	std::swap(m_fForcedPrimaryX, hOther.m_fForcedPrimaryX);
+	std::swap(m_fForcedPrimaryY, hOther.m_fForcedPrimaryY);
+	std::swap(m_fForcedPrimaryZ, hOther.m_fForcedPrimaryZ);
+	std::swap(m_fPrimaryCx, hOther.m_fPrimaryCx);
+	std::swap(m_fPrimaryCy, hOther.m_fPrimaryCy);
+	std::swap(m_fPrimaryCz, hOther.m_fPrimaryCz);
+	std::swap(m_fPrimaryE, hOther.m_fPrimaryE);
+	std::swap(m_fPrimaryW, hOther.m_fPrimaryW);
+	std::swap(m_iNbClusters, hOther.m_iNbClusters);
+	std::swap(m_fS1, hOther.m_fS1);
+	std::swap(m_fS2, hOther.m_fS2);
+
+	m_hPMTHits.swap(hOther.m_hPMTHits);
+	m_hTrackId.swap(hOther.m_hTrackId);
+	m_hParentId.swap(hOther.m_hParentId);
+	m_hParticleType.swap(hOther.m_hParticleType);
+	m_hParentType.swap(hOther.m_hParentType);
+	m_hCreatorProcess.swap(hOther.m_hCreatorProcess);
+	m_hDepositingProcess.swap(hOther.m_hDepositingProcess);
+	m_hX.swap(hOther.m_hX);
+	m_hY.swap(hOther.m_hY);
+	m_hZ.swap(hOther.m_hZ);
+	m_hEnergyDeposited.swap(hOther.m_hEnergyDeposited);
+	m_hPreStepEnergy.swap(hOther.m_hPreStepEnergy);
+	m_hPostStepEnergy.swap(hOther.m_hPostStepEnergy);
+	m_hTime.swap(hOther.m_hTime);
+	m_hPrimaryParticleType.swap(hOther.m_hPrimaryParticleType);
+	m_hClusterEnergy.swap(hOther.m_hClusterEnergy);
+	m_hClusterX.swap(hOther.m_hClusterX);
+	m_hClusterY.swap(hOther.m_hClusterY);
+	m_hClusterZ.swap(hOther.m_hClusterZ);
+	m_hClusterNbPhotons.swap(hOther.m_hClusterNbPhotons);
+	m_hClusterNbElectrons.swap(hOther.m_hClusterNbElectrons);
+	m_hClusterDriftTime.swap(hOther.m_hClusterDriftTime);
+	m_hClusterS1.swap(hOther.m_hClusterS1);
+	m_hClusterS2.swap(hOther.m_hClusterS2);
+}
+
+void HTPCEventData::Reserve(size_t iNbSteps, size_t iNbClusters)
+{
+	m_hTrackId.reserve(iNbSteps);
+	m_hParentId.reserve(iNbSteps);
+	m_hParticleType.reserve(iNbSteps);
+	m_hParentType.reserve(iNbSteps);
+	m_hCreatorProcess.reserve(iNbSteps);
+	m_hDepositingProcess.reserve(iNbSteps);
+	m_hX.reserve(iNbSteps);
+	m_hY.reserve(iNbSteps);
+	m_hZ.reserve(iNbSteps);
+	m_hEnergyDeposited.reserve(iNbSteps);
+	m_hPreStepEnergy.reserve(iNbSteps);
+	m_hPostStepEnergy.reserve(iNbSteps);
+	m_hTime.reserve(iNbSteps);
+
+	m_hClusterEnergy.reserve(iNbClusters);
+	m_hClusterX.reserve(iNbClusters);
+	m_hClusterY.reserve(iNbClusters);
+	m_hClusterZ.reserve(iNbClusters);
+	m_hClusterNbPhotons.reserve(iNbClusters);
+	m_hClusterNbElectrons.reserve(iNbClusters);
+	m_hClusterDriftTime.reserve(iNbClusters);
+	m_hClusterS1.reserve(iNbClusters);
+	m_hClusterS2.reserve(iNbClusters);
+}
@@ -0,0 +1,267 @@
+#include "HTPCGeometryValidator.hh"
+
+// G4 Header Files
+#include <G4AffineTransform.hh>
+#include <G4LogicalVolume.hh>
+#include <G4LogicalVolumeStore.hh>
+#include <G4Material.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4Timer.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4VSolid.hh>
+#include <G4ios.hh>
+
+// Additional Header Files
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <iomanip>
+#include <set>
+#include <thread>
+#include <utility>
+
+HTPCGeometryValidator::HTPCGeometryValidator(G4int iResolution,
+                                             G4int iNbThreads,
+                                             G4double dTolerance) {
+  m_iResolution = std::max(1, iResolution);
+  m_iNbThreads = iNbThreads;
+  m_dTolerance = dTolerance;
+}
+
+HTPCGeometryValidator::~HTPCGeometryValidator() {}
+
+G4int HTPCGeometryValidator::CheckOverlaps(G4VPhysicalVolume *pWorld) {
+  G4Timer hTimer;
+  hTimer.Start();
+
+  m_hMothers.clear();
+  m_hPlacements.clear();
+  m_hSurfacePoints.clear();
+
+  CollectPlacements(pWorld->GetLogicalVolume());
+
+  // sample the surfaces serially, one set of points per solid
+  for (const auto &hPlacement : m_hPlacements) {
+    G4VSolid *pSolid = hPlacement.pVolume->GetLogicalVolume()->GetSolid();
+    if (m_hSurfacePoints.count(pSolid)) continue;
+
+    vector<G4ThreeVector> &hPoints = m_hSurfacePoints[pSolid];
+    hPoints.reserve(m_iResolution);
+    for (G4int i = 0; i < m_iResolution; ++i)
+      hPoints.push_back(pSolid->GetPointOnSurface());
+  }
+
+  G4int iNbThreads = m_iNbThreads;
+  if (iNbThreads <= 0)
+    iNbThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  G4cout << "HTPCGeometryValidator: checking " << m_hPlacements.size()
+         << " placements in " << m_hMothers.size() << " mother volumes ("
+         << m_hSurfacePoints.size() << " solids, " << m_iResolution
+         << " points each) on " << iNbThreads << " threads" << G4endl;
+
+  std::atomic<size_t> iNextPlacement(0);
+  vector<vector<Overlap> > hThreadOverlaps(iNbThreads);
+  vector<std::thread> hThreads;
+  for (G4int iThread = 0; iThread < iNbThreads; ++iThread) {
+    hThreads.emplace_back([this, iThread, &iNextPlacement, &hThreadOverlaps]() {
+      size_t iPlacement;
+      while ((iPlacement = iNextPlacement++) < m_hPlacements.size())
+        CheckPlacement(iPlacement, hThreadOverlaps[iThread]);
+    });
+  }
+  for (auto &hThread : hThreads) hThread.join();
+
+  vector<Overlap> hOverlaps;
+  for (const auto &hOverlapsOfThread : hThreadOverlaps)
+    hOverlaps.insert(hOverlaps.end(), hOverlapsOfThread.begin(),
+                     hOverlapsOfThread.end());
+  std::sort(hOverlaps.begin(), hOverlaps.end(),
+            [](const Overlap &a, const Overlap &b) {
+              return a.iPlacement != b.iPlacement ? a.iPlacement < b.iPlacement
+                                                  : a.iOther < b.iOther;
+            });
+
+  // every pair of sisters is seen from both sides, count it once
+  std::set<std::pair<G4int, G4int> > hPairs;
+  for (const auto &hOverlap : hOverlaps) {
+    const Placement &hPlacement = m_hPlacements[hOverlap.iPlacement];
+    G4VPhysicalVolume *pVolume = hPlacement.pVolume;
+
+    G4cout << "HTPCGeometryValidator: overlap - " << pVolume->GetName() << ":"
+           << pVolume->GetCopyNo();
+    if (hOverlap.iOther < 0) {
+      G4cout << " protrudes from mother " << hPlacement.pMother->GetName();
+      hPairs.insert(std::make_pair(-1, (G4int)hOverlap.iPlacement));
+    } else {
+      G4VPhysicalVolume *pOther = m_hPlacements[hOverlap.iOther].pVolume;
+      G4cout << " overlaps with " << pOther->GetName() << ":"
+             << pOther->GetCopyNo();
+      hPairs.insert(
+          std::make_pair(std::min((G4int)hOverlap.iPlacement, hOverlap.iOther),
+                         std::max((G4int)hOverlap.iPlacement, hOverlap.iOther)));
+    }
+    G4cout << " by up to " << hOverlap.dDepth / mm << " mm at "
+           << hOverlap.hPoint / mm << " mm (mother frame), "
+           << hOverlap.iNbPoints << "/" << m_iResolution << " points" << G4endl;
+  }
+
+  hTimer.Stop();
+  G4cout << "HTPCGeometryValidator: " << hPairs.size()
+         << " overlaps found in " << hTimer.GetRealElapsed() << " s" << G4endl;
+
+  return hPairs.size();
+}
+
+void HTPCGeometryValidator::PrintVolumeReport() {
+  G4LogicalVolumeStore *pStore = G4LogicalVolumeStore::GetInstance();
+
+  G4cout << G4endl << "HTPCGeometryValidator: volume report" << G4endl
+         << std::setw(36) << std::left << "logical volume" << std::setw(24)
+         << "material" << std::right << std::setw(16) << "volume [cm3]"
+         << std::setw(16) << "density [g/cm3]" << std::setw(16) << "mass [kg]"
+         << std::setw(20) << "with daughters [kg]" << G4endl;
+
+  for (G4LogicalVolume *pLogicalVolume : *pStore) {
+    G4Material *pMaterial = pLogicalVolume->GetMaterial();
+
+    G4double dVolume = pLogicalVolume->GetSolid()->GetCubicVolume();
+    G4double dMass = pLogicalVolume->GetMass(true, false);
+    G4double dTotalMass = pLogicalVolume->GetMass(true, true);
+
+    G4cout << std::setw(36) << std::left << pLogicalVolume->GetName()
+           << std::setw(24) << pMaterial->GetName() << std::right
+           << std::setw(16) << dVolume / cm3 << std::setw(16)
+           << pMaterial->GetDensity() / (g / cm3) << std::setw(16)
+           << dMass / kg << std::setw(20) << dTotalMass / kg << G4endl;
+  }
+}
+
+void HTPCGeometryValidator::CollectPlacements(G4LogicalVolume *pMother) {
+  if (std::find(m_hMothers.begin(), m_hMothers.end(), pMother) !=
+      m_hMothers.end())
+    return;
+  if (!pMother->GetNoDaughters()) return;
+
+  m_hMothers.push_back(pMother);
+
+  size_t iFirst = m_hPlacements.size();
+  for (size_t iDaughter = 0; iDaughter < pMother->GetNoDaughters();
+       ++iDaughter) {
+    G4VPhysicalVolume *pDaughter = pMother->GetDaughter(iDaughter);
+    if (pDaughter->IsReplicated()) {
+      G4cout << "HTPCGeometryValidator: skipping replicated volume "
+             << pDaughter->GetName() << G4endl;
+      continue;
+    }
+
+    // bounding box of the daughter in the mother frame
+    G4ThreeVector hMin, hMax;
+    pDaughter->GetLogicalVolume()->GetSolid()->BoundingLimits(hMin, hMax);
+    G4AffineTransform hTransform(pDaughter->GetRotation(),
+                                 pDaughter->GetTranslation());
+
+    Placement hPlacement;
+    hPlacement.pVolume = pDaughter;
+    hPlacement.pMother = pMother;
+    hPlacement.hBoxMin = G4ThreeVector(DBL_MAX, DBL_MAX, DBL_MAX);
+    hPlacement.hBoxMax = G4ThreeVector(-DBL_MAX, -DBL_MAX, -DBL_MAX);
+    for (G4int iCorner = 0; iCorner < 8; ++iCorner) {
+      G4ThreeVector hCorner(iCorner & 1 ? hMax.x() : hMin.x(),
+                            iCorner & 2 ? hMax.y() : hMin.y(),
+                            iCorner & 4 ? hMax.z() : hMin.z());
+      hCorner = hTransform.TransformPoint(hCorner);
+      for (G4int i = 0; i < 3; ++i) {
+        hPlacement.hBoxMin[i] = std::min(hPlacement.hBoxMin[i], hCorner[i]);
+        hPlacement.hBoxMax[i] = std::max(hPlacement.hBoxMax[i], hCorner[i]);
+      }
+    }
+    m_hPlacements.push_back(hPlacement);
+  }
+
+  // sisters only need to be tested where the bounding boxes intersect
+  size_t iLast = m_hPlacements.size();
+  for (size_t i = iFirst; i < iLast; ++i) {
+    for (size_t j = i + 1; j < iLast; ++j) {
+      G4bool bIntersect = true;
+      for (G4int k = 0; k < 3 && bIntersect; ++k)
+        bIntersect = m_hPlacements[i].hBoxMin[k] <=
+                         m_hPlacements[j].hBoxMax[k] + m_dTolerance &&
+                     m_hPlacements[j].hBoxMin[k] <=
+                         m_hPlacements[i].hBoxMax[k] + m_dTolerance;
+      if (bIntersect) {
+        m_hPlacements[i].hCandidates.push_back(j);
+        m_hPlacements[j].hCandidates.push_back(i);
+      }
+    }
+  }
+
+  for (size_t i = iFirst; i < iLast; ++i)
+    CollectPlacements(m_hPlacements[i].pVolume->GetLogicalVolume());
+}
+
+void HTPCGeometryValidator::CheckPlacement(size_t iPlacement,
+                                           vector<Overlap> &hOverlaps) const {
+  const Placement &hPlacement = m_hPlacements[iPlacement];
+  G4VPhysicalVolume *pVolume = hPlacement.pVolume;
+  G4VSolid *pMotherSolid = hPlacement.pMother->GetSolid();
+
+  const vector<G4ThreeVector> &hPoints =
+      m_hSurfacePoints.find(pVolume->GetLogicalVolume()->GetSolid())->second;
+
+  G4AffineTransform hTransform(pVolume->GetRotation(),
+                               pVolume->GetTranslation());
+
+  size_t iFirstOverlap = hOverlaps.size();
+  auto Record = [&](G4int iOther, const G4ThreeVector &hPoint,
+                    G4double dDepth) {
+    for (size_t i = iFirstOverlap; i < hOverlaps.size(); ++i) {
+      if (hOverlaps[i].iOther != iOther) continue;
+      ++hOverlaps[i].iNbPoints;
+      if (dDepth > hOverlaps[i].dDepth) {
+        hOverlaps[i].dDepth = dDepth;
+        hOverlaps[i].hPoint = hPoint;
+      }
+      return;
+    }
+    Overlap hOverlap;
+    hOverlap.iPlacement = iPlacement;
+    hOverlap.iOther = iOther;
+    hOverlap.hPoint = hPoint;
+    hOverlap.dDepth = dDepth;
+    hOverlap.iNbPoints = 1;
+    hOverlaps.push_back(hOverlap);
+  };
+
+  for (const G4ThreeVector &hLocalPoint : hPoints) {
+    G4ThreeVector hPoint = hTransform.TransformPoint(hLocalPoint);
+
+    // the daughter must be contained in its mother
+    if (pMotherSolid->Inside(hPoint) == kOutside) {
+      G4double dDepth = pMotherSolid->DistanceToIn(hPoint);
+      if (dDepth > m_dTolerance) Record(-1, hPoint, dDepth);
+    }
+
+    // and its surface must not be inside any sister
+    for (size_t iCandidate : hPlacement.hCandidates) {
+      const Placement &hSister = m_hPlacements[iCandidate];
+
+      G4bool bInBox = true;
+      for (G4int k = 0; k < 3 && bInBox; ++k)
+        bInBox = hPoint[k] >= hSister.hBoxMin[k] - m_dTolerance &&
+                 hPoint[k] <= hSister.hBoxMax[k] + m_dTolerance;
+      if (!bInBox) continue;
+
+      G4AffineTransform hSisterTransform(hSister.pVolume->GetRotation(),
+                                         hSister.pVolume->GetTranslation());
+      G4ThreeVector hSisterPoint =
+          hSisterTransform.InverseTransformPoint(hPoint);
+      G4VSolid *pSisterSolid = hSister.pVolume->GetLogicalVolume()->GetSolid();
+
+      if (pSisterSolid->Inside(hSisterPoint) == kInside) {
+        G4double dDepth = pSisterSolid->DistanceToOut(hSisterPoint);
+        if (dDepth > m_dTolerance) Record((G4int)iCandidate, hPoint, dDepth);
+      }
+    }
+  }
+}
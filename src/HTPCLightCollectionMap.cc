@@ -0,0 +1,220 @@
+#include "HTPCLightCollectionMap.hh"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const char szMagic[8] = {'H', 'T', 'P', 'C', 'L', 'C', 'E', '1'};
+// magic, bins, PMTs and grid limits
+const size_t iHeaderSize = 8 + 4 * sizeof(uint32_t) + 6 * sizeof(double);
+
+template <typename T>
+void ReadArray(std::ifstream &hFile, std::vector<T> &hArray, size_t iSize,
+               const std::string &hFilename) {
+  hArray.resize(iSize);
+  if (iSize && !hFile.read(reinterpret_cast<char *>(&hArray[0]),
+                           iSize * sizeof(T)))
+    throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                             " is truncated");
+}
+
+}  // namespace
+
+HTPCLightCollectionMap::HTPCLightCollectionMap() : m_iNbPMTs(0) {
+  for (int i = 0; i < 3; ++i) {
+    m_iNbBins[i] = 0;
+    m_dMin[i] = m_dMax[i] = 0.;
+  }
+}
+
+void HTPCLightCollectionMap::Load(const std::string &hFilename) {
+  m_hOffsets.clear();
+  m_hPMTs.clear();
+  m_hProbabilities.clear();
+
+  std::ifstream hFile(hFilename.c_str(), std::ios::binary | std::ios::ate);
+  if (!hFile)
+    throw std::runtime_error("HTPCLightCollectionMap: cannot open " +
+                             hFilename);
+  const uint64_t iFileSize = hFile.tellg();
+  hFile.seekg(0);
+
+  char szFileMagic[8];
+  if (!hFile.read(szFileMagic, sizeof(szFileMagic)) ||
+      std::memcmp(szFileMagic, szMagic, sizeof(szMagic)))
+    throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                             " is not a light collection map");
+
+  hFile.read(reinterpret_cast<char *>(m_iNbBins), sizeof(m_iNbBins));
+  hFile.read(reinterpret_cast<char *>(&m_iNbPMTs), sizeof(m_iNbPMTs));
+  for (int i = 0; i < 3; ++i) {
+    hFile.read(reinterpret_cast<char *>(&m_dMin[i]), sizeof(double));
+    hFile.read(reinterpret_cast<char *>(&m_dMax[i]), sizeof(double));
+  }
+  if (!hFile)
+    throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                             " is truncated");
+
+  for (int i = 0; i < 3; ++i)
+    if (!m_iNbBins[i] || !(m_dMax[i] > m_dMin[i]))
+      throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                               " has an invalid grid");
+  if (m_iNbPMTs > 65535)
+    throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                             " has too many PMTs");
+
+  // the offsets of the grid must fit the file before anything is allocated;
+  // nx*ny cannot overflow 64 bits, the product with nz is checked by division
+  const uint64_t iDataSize = iFileSize - iHeaderSize;
+  const uint64_t iEntrySize = sizeof(uint16_t) + sizeof(float);
+  const uint64_t iNbSlices = uint64_t(m_iNbBins[0]) * m_iNbBins[1];
+  if (iDataSize < sizeof(uint64_t) ||
+      iNbSlices > (iDataSize / sizeof(uint64_t) - 1) / m_iNbBins[2])
+    throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                             " is too short for its grid");
+  const uint64_t iNbVoxels = GetNbVoxels();
+
+  std::vector<uint64_t> hOffsets;
+  std::vector<uint16_t> hPMTs;
+  std::vector<float> hProbabilities;
+  ReadArray(hFile, hOffsets, iNbVoxels + 1, hFilename);
+
+  // at most one entry per voxel and PMT, filling the rest of the file
+  const uint64_t iNbEntries = hOffsets.back();
+  const uint64_t iEntriesSize = iDataSize - (iNbVoxels + 1) * sizeof(uint64_t);
+  if (hOffsets[0] != 0 || iNbEntries > iNbVoxels * m_iNbPMTs ||
+      iNbEntries > iEntriesSize / iEntrySize ||
+      iNbEntries * iEntrySize != iEntriesSize)
+    throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                             " does not match the size of its header");
+  for (size_t i = 1; i < hOffsets.size(); ++i)
+    if (hOffsets[i] < hOffsets[i - 1])
+      throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                               " has invalid offsets");
+
+  ReadArray(hFile, hPMTs, iNbEntries, hFilename);
+  ReadArray(hFile, hProbabilities, iNbEntries, hFilename);
+  for (size_t i = 0; i < iNbEntries; ++i)
+    if (hPMTs[i] >= m_iNbPMTs)
+      throw std::runtime_error("HTPCLightCollectionMap: " + hFilename +
+                               " refers to a PMT out of range");
+
+  m_hOffsets.swap(hOffsets);
+  m_hPMTs.swap(hPMTs);
+  m_hProbabilities.swap(hProbabilities);
+}
+
+long HTPCLightCollectionMap::FindVoxel(double x, double y, double z) const {
+  if (!IsLoaded()) return -1;
+
+  const double pdPoint[3] = {x, y, z};
+  long iIndex[3];
+  for (int i = 0; i < 3; ++i) {
+    if (pdPoint[i] < m_dMin[i] || pdPoint[i] >= m_dMax[i]) return -1;
+    iIndex[i] = static_cast<long>(std::floor(
+        (pdPoint[i] - m_dMin[i]) / (m_dMax[i] - m_dMin[i]) * m_iNbBins[i]));
+    if (iIndex[i] >= (long)m_iNbBins[i]) iIndex[i] = m_iNbBins[i] - 1;
+  }
+
+  // x runs fastest
+  return (iIndex[2] * m_iNbBins[1] + iIndex[1]) * m_iNbBins[0] + iIndex[0];
+}
+
+void HTPCLightCollectionMap::GetVoxelCenter(long iVoxel, double &x, double &y,
+                                            double &z) const {
+  long iIndex[3];
+  iIndex[0] = iVoxel % m_iNbBins[0];
+  iIndex[1] = (iVoxel / m_iNbBins[0]) % m_iNbBins[1];
+  iIndex[2] = iVoxel / m_iNbBins[0] / m_iNbBins[1];
+
+  double pdCenter[3];
+  for (int i = 0; i < 3; ++i)
+    pdCenter[i] =
+        m_dMin[i] + (iIndex[i] + 0.5) * (m_dMax[i] - m_dMin[i]) / m_iNbBins[i];
+
+  x = pdCenter[0];
+  y = pdCenter[1];
+  z = pdCenter[2];
+}
+
+void HTPCLightCollectionMap::Book(const unsigned piNbBins[3],
+                                  const double pdMin[3], const double pdMax[3],
+                                  unsigned iNbPMTs) {
+  for (int i = 0; i < 3; ++i)
+    if (!piNbBins[i] || !(pdMax[i] > pdMin[i]))
+      throw std::invalid_argument("HTPCLightCollectionMap: empty grid");
+  if (iNbPMTs > 65535)
+    throw std::invalid_argument("HTPCLightCollectionMap: too many PMTs");
+
+  for (int i = 0; i < 3; ++i) {
+    m_iNbBins[i] = piNbBins[i];
+    m_dMin[i] = pdMin[i];
+    m_dMax[i] = pdMax[i];
+  }
+  m_iNbPMTs = iNbPMTs;
+
+  // an empty map, so that FindVoxel() works while building
+  m_hOffsets.assign(GetNbVoxels() + 1, 0);
+  m_hPMTs.clear();
+  m_hProbabilities.clear();
+
+  m_hEmitted.assign(GetNbVoxels(), 0);
+  m_hDetected.assign(GetNbVoxels(), std::map<uint16_t, uint64_t>());
+}
+
+void HTPCLightCollectionMap::AddEmitted(long iVoxel, uint64_t iNbPhotons) {
+  m_hEmitted[iVoxel] += iNbPhotons;
+}
+
+void HTPCLightCollectionMap::AddDetected(long iVoxel, unsigned iPMT,
+                                         uint64_t iNbPhotons) {
+  if (iPMT >= m_iNbPMTs) return;
+  m_hDetected[iVoxel][iPMT] += iNbPhotons;
+}
+
+void HTPCLightCollectionMap::Write(const std::string &hFilename) const {
+  const size_t iNbVoxels = GetNbVoxels();
+
+  std::vector<uint64_t> hOffsets(iNbVoxels + 1, 0);
+  std::vector<uint16_t> hPMTs;
+  std::vector<float> hProbabilities;
+
+  for (size_t iVoxel = 0; iVoxel < iNbVoxels; ++iVoxel) {
+    if (m_hEmitted[iVoxel]) {
+      for (const auto &hDetected : m_hDetected[iVoxel]) {
+        hPMTs.push_back(hDetected.first);
+        hProbabilities.push_back(
+            static_cast<float>(double(hDetected.second) / m_hEmitted[iVoxel]));
+      }
+    }
+    hOffsets[iVoxel + 1] = hPMTs.size();
+  }
+
+  std::ofstream hFile(hFilename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!hFile)
+    throw std::runtime_error("HTPCLightCollectionMap: cannot write " +
+                             hFilename);
+
+  hFile.write(szMagic, sizeof(szMagic));
+  hFile.write(reinterpret_cast<const char *>(m_iNbBins), sizeof(m_iNbBins));
+  hFile.write(reinterpret_cast<const char *>(&m_iNbPMTs), sizeof(m_iNbPMTs));
+  for (int i = 0; i < 3; ++i) {
+    hFile.write(reinterpret_cast<const char *>(&m_dMin[i]), sizeof(double));
+    hFile.write(reinterpret_cast<const char *>(&m_dMax[i]), sizeof(double));
+  }
+  hFile.write(reinterpret_cast<const char *>(&hOffsets[0]),
+              hOffsets.size() * sizeof(uint64_t));
+  if (!hPMTs.empty()) {
+    hFile.write(reinterpret_cast<const char *>(&hPMTs[0]),
+                hPMTs.size() * sizeof(uint16_t));
+    hFile.write(reinterpret_cast<const char *>(&hProbabilities[0]),
+                hProbabilities.size() * sizeof(float));
+  }
+
+  if (!hFile)
+    throw std::runtime_error("HTPCLightCollectionMap: error writing " +
+                             hFilename);
+}
@@ -0,0 +1,156 @@
+#include "HTPCPMTPacking.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<HTPCPMTPacking::Position> HTPCPMTPacking::Hexagonal(
+    double dOuterRadius, double dPMTRadius, double dPitch, int iMaxCount) {
+  std::vector<Position> hPositions;
+
+  const double dy = HexRowSpacing(dPitch);
+
+  double y = -dOuterRadius;
+  int iRow = 0;
+  while (y <= dOuterRadius &&
+         (iMaxCount <= 0 || (int)hPositions.size() < iMaxCount)) {
+    double x = -dOuterRadius + (iRow % 2 == 0 ? 0.0 : 0.5 * dPitch);
+
+    while (x <= dOuterRadius &&
+           (iMaxCount <= 0 || (int)hPositions.size() < iMaxCount)) {
+      // keep the PMT if its whole footprint fits
+      if (std::sqrt(x * x + y * y) + dPMTRadius <= dOuterRadius)
+        hPositions.push_back(Position{x, y});
+
+      x += dPitch;
+    }
+
+    y += dy;
+    ++iRow;
+  }
+
+  // the grid starts at the edge, centre what was kept
+  if (!hPositions.empty()) {
+    double dCentroidX = 0., dCentroidY = 0.;
+    for (const auto &hPosition : hPositions) {
+      dCentroidX += hPosition.x;
+      dCentroidY += hPosition.y;
+    }
+    dCentroidX /= hPositions.size();
+    dCentroidY /= hPositions.size();
+
+    for (auto &hPosition : hPositions) {
+      hPosition.x -= dCentroidX;
+      hPosition.y -= dCentroidY;
+    }
+  }
+
+  return hPositions;
+}
+
+std::vector<HTPCPMTPacking::Position> HTPCPMTPacking::Rings(
+    double dOuterRadius, double dPMTRadius, double dPitch, int iMaxCount) {
+  std::vector<Position> hPositions;
+
+  if (dPMTRadius > dOuterRadius) return hPositions;
+
+  hPositions.push_back(Position{0., 0.});
+
+  for (int iRing = 1; iRing * dPitch + dPMTRadius <= dOuterRadius; ++iRing) {
+    const double dRadius = iRing * dPitch;
+    const int iNbOnRing = RingCount(iRing);
+    const double dStep = 2. * M_PI / iNbOnRing;
+    const double dPhase = (iRing % 2) ? 0.5 * dStep : 0.;
+
+    for (int i = 0; i < iNbOnRing; ++i) {
+      if (iMaxCount > 0 && (int)hPositions.size() >= iMaxCount)
+        return hPositions;
+
+      const double dPhi = dPhase + i * dStep;
+      hPositions.push_back(
+          Position{dRadius * std::cos(dPhi), dRadius * std::sin(dPhi)});
+    }
+  }
+
+  if (iMaxCount > 0 && (int)hPositions.size() > iMaxCount)
+    hPositions.resize(iMaxCount);
+
+  return hPositions;
+}
+
+std::vector<HTPCPMTPacking::Position> HTPCPMTPacking::FromFile(
+    const std::string &hFilename, int iMaxCount) {
+  std::ifstream hFile(hFilename.c_str());
+  if (!hFile)
+    throw std::runtime_error("HTPCPMTPacking: cannot open PMT layout file " +
+                             hFilename);
+
+  std::vector<Position> hPositions;
+  std::string hLine;
+  int iLine = 0;
+  while (std::getline(hFile, hLine)) {
+    ++iLine;
+
+    hLine = hLine.substr(0, hLine.find('#'));
+    std::replace(hLine.begin(), hLine.end(), ',', ' ');
+    if (hLine.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    std::istringstream hStream(hLine);
+    Position hPosition;
+    if (!(hStream >> hPosition.x >> hPosition.y))
+      throw std::runtime_error("HTPCPMTPacking: cannot parse line " +
+                               std::to_string(iLine) + " of " + hFilename);
+
+    hPositions.push_back(hPosition);
+    if (iMaxCount > 0 && (int)hPositions.size() >= iMaxCount) break;
+  }
+
+  return hPositions;
+}
+
+std::vector<HTPCPMTPacking::Position> HTPCPMTPacking::Generate(
+    Layout iLayout, double dOuterRadius, double dPMTRadius, double dPitch,
+    int iMaxCount, const std::string &hFilename) {
+  switch (iLayout) {
+    case kHexagonal:
+      return Hexagonal(dOuterRadius, dPMTRadius, dPitch, iMaxCount);
+    case kRings:
+      return Rings(dOuterRadius, dPMTRadius, dPitch, iMaxCount);
+    case kFile:
+      return FromFile(hFilename, iMaxCount);
+  }
+
+  return std::vector<Position>();
+}
+
+HTPCPMTPacking::Layout HTPCPMTPacking::ParseLayout(const std::string &hLayout) {
+  if (hLayout == "hex") return kHexagonal;
+  if (hLayout == "rings") return kRings;
+  if (hLayout == "file") return kFile;
+
+  throw std::invalid_argument("HTPCPMTPacking: unknown PMT layout " + hLayout);
+}
+
+double HTPCPMTPacking::MinimumDistance(const std::vector<Position> &hPositions) {
+  if (hPositions.size() < 2) return 0.;
+
+  // sweep along x so only close neighbours are compared
+  std::vector<Position> hSorted(hPositions);
+  std::sort(hSorted.begin(), hSorted.end(),
+            [](const Position &a, const Position &b) { return a.x < b.x; });
+
+  double dMinimum = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < hSorted.size(); ++i) {
+    for (size_t j = i + 1;
+         j < hSorted.size() && hSorted[j].x - hSorted[i].x < dMinimum; ++j) {
+      double dx = hSorted[j].x - hSorted[i].x;
+      double dy = hSorted[j].y - hSorted[i].y;
+      dMinimum = std::min(dMinimum, std::sqrt(dx * dx + dy * dy));
+    }
+  }
+
+  return dMinimum;
+}
@@ -0,0 +1,210 @@
+#ifdef HTPC_WITH_ARROW
+
+#include "HTPCParquetWriter.hh"
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+
+#include <stdexcept>
+
+#include "HTPCEventData.hh"
+
+namespace {
+
+template <typename Builder, typename T>
+std::shared_ptr<arrow::Array> MakeArray(const std::vector<T> &hValues) {
+  Builder hBuilder;
+  PARQUET_THROW_NOT_OK(hBuilder.AppendValues(hValues));
+  std::shared_ptr<arrow::Array> pArray;
+  PARQUET_THROW_NOT_OK(hBuilder.Finish(&pArray));
+  return pArray;
+}
+
+std::shared_ptr<arrow::Array> MakeArray(const std::vector<int> &hValues) {
+  return MakeArray<arrow::Int32Builder>(hValues);
+}
+
+std::shared_ptr<arrow::Array> MakeArray(const std::vector<float> &hValues) {
+  return MakeArray<arrow::FloatBuilder>(hValues);
+}
+
+std::shared_ptr<arrow::Array> MakeArray(
+    const std::vector<std::string> &hValues) {
+  return MakeArray<arrow::StringBuilder>(hValues);
+}
+
+std::shared_ptr<arrow::Schema> StepsSchema() {
+  return arrow::schema({arrow::field("eventid", arrow::int32()),
+                        arrow::field("trackid", arrow::int32()),
+                        arrow::field("parentid", arrow::int32()),
+                        arrow::field("type", arrow::utf8()),
+                        arrow::field("parenttype", arrow::utf8()),
+                        arrow::field("creaproc", arrow::utf8()),
+                        arrow::field("edproc", arrow::utf8()),
+                        arrow::field("xp", arrow::float32()),
+                        arrow::field("yp", arrow::float32()),
+                        arrow::field("zp", arrow::float32()),
+                        arrow::field("ed", arrow::float32()),
+                        arrow::field("PreStepEnergy", arrow::float32()),
+                        arrow::field("PostStepEnergy", arrow::float32()),
+                        arrow::field("time", arrow::float32())});
+}
+
+std::shared_ptr<arrow::Schema> PrimariesSchema() {
+  return arrow::schema({arrow::field("eventid", arrow::int32()),
+                        arrow::field("type_pri", arrow::utf8()),
+                        arrow::field("xp_pri", arrow::float32()),
+                        arrow::field("yp_pri", arrow::float32()),
+                        arrow::field("zp_pri", arrow::float32()),
+                        arrow::field("cx_pri", arrow::float32()),
+                        arrow::field("cy_pri", arrow::float32()),
+                        arrow::field("cz_pri", arrow::float32()),
+                        arrow::field("e_pri", arrow::float32()),
+                        arrow::field("w_pri", arrow::float32()),
+                        arrow::field("etot", arrow::float32()),
+                        arrow::field("nsteps", arrow::int32())});
+}
+
+std::unique_ptr<parquet::arrow::FileWriter> OpenWriter(
+    const std::string &hFilename, const std::shared_ptr<arrow::Schema> &pSchema) {
+  std::shared_ptr<arrow::io::FileOutputStream> pFile;
+  PARQUET_ASSIGN_OR_THROW(pFile,
+                          arrow::io::FileOutputStream::Open(hFilename));
+
+  std::unique_ptr<parquet::arrow::FileWriter> pWriter;
+  PARQUET_ASSIGN_OR_THROW(
+      pWriter, parquet::arrow::FileWriter::Open(
+                   *pSchema, arrow::default_memory_pool(), pFile,
+                   parquet::WriterProperties::Builder()
+                       .compression(parquet::Compression::SNAPPY)
+                       ->build()));
+  return pWriter;
+}
+
+}  // namespace
+
+HTPCParquetWriter::HTPCParquetWriter(const std::string &hBasename,
+                                     size_t iBatchSize)
+    : m_iBatchSize(iBatchSize ? iBatchSize : 1), m_pBatch(new Batch()) {
+  try {
+    m_pStepsWriter = OpenWriter(hBasename + "_steps.parquet", StepsSchema());
+    m_pPrimariesWriter =
+        OpenWriter(hBasename + "_primaries.parquet", PrimariesSchema());
+  } catch (const std::exception &hError) {
+    throw std::runtime_error("HTPCParquetWriter: cannot open " + hBasename +
+                             "_*.parquet: " + hError.what());
+  }
+
+  m_pQueue.reset(new HTPCAsyncQueue<std::unique_ptr<Batch> >(
+      [this](std::unique_ptr<Batch> &pBatch) { Write(*pBatch); }));
+}
+
+HTPCParquetWriter::~HTPCParquetWriter() {
+  try {
+    Close();
+  } catch (const std::exception &) {
+  }
+}
+
+void HTPCParquetWriter::Fill(const HTPCEventData &hEventData) {
+  Batch &hBatch = *m_pBatch;
+
+  for (size_t i = 0; i < hEventData.m_hTrackId.size(); ++i) {
+    hBatch.hEventId.push_back(hEventData.m_iEventId);
+    hBatch.hTrackId.push_back(hEventData.m_hTrackId[i]);
+    hBatch.hParentId.push_back(hEventData.m_hParentId[i]);
+    hBatch.hType.push_back(hEventData.m_hParticleType[i]);
+    hBatch.hParentType.push_back(hEventData.m_hParentType[i]);
+    hBatch.hCreatorProcess.push_back(hEventData.m_hCreatorProcess[i]);
+    hBatch.hDepositingProcess.push_back(hEventData.m_hDepositingProcess[i]);
+    hBatch.hX.push_back(hEventData.m_hX[i]);
+    hBatch.hY.push_back(hEventData.m_hY[i]);
+    hBatch.hZ.push_back(hEventData.m_hZ[i]);
+    hBatch.hEnergyDeposited.push_back(hEventData.m_hEnergyDeposited[i]);
+    hBatch.hPreStepEnergy.push_back(hEventData.m_hPreStepEnergy[i]);
+    hBatch.hPostStepEnergy.push_back(hEventData.m_hPostStepEnergy[i]);
+    hBatch.hTime.push_back(hEventData.m_hTime[i]);
+  }
+
+  hBatch.hPrimaryEventId.push_back(hEventData.m_iEventId);
+  hBatch.hPrimaryType.push_back(hEventData.m_hPrimaryParticleType.empty()
+                                    ? std::string()
+                                    : hEventData.m_hPrimaryParticleType.front());
+  hBatch.hPrimaryX.push_back(hEventData.m_fPrimaryX);
+  hBatch.hPrimaryY.push_back(hEventData.m_fPrimaryY);
+  hBatch.hPrimaryZ.push_back(hEventData.m_fPrimaryZ);
+  hBatch.hPrimaryCx.push_back(hEventData.m_fPrimaryCx);
+  hBatch.hPrimaryCy.push_back(hEventData.m_fPrimaryCy);
+  hBatch.hPrimaryCz.push_back(hEventData.m_fPrimaryCz);
+  hBatch.hPrimaryE.push_back(hEventData.m_fPrimaryE);
+  hBatch.hPrimaryW.push_back(hEventData.m_fPrimaryW);
+  hBatch.hTotalEnergy.push_back(hEventData.m_fTotalEnergyDeposited);
+  hBatch.hNbSteps.push_back(hEventData.m_iNbSteps);
+
+  if (hBatch.hEventId.size() >= m_iBatchSize ||
+      hBatch.hPrimaryEventId.size() >= m_iBatchSize)
+    Flush();
+}
+
+void HTPCParquetWriter::Flush() {
+  if (m_pBatch->hPrimaryEventId.empty()) return;
+
+  m_pQueue->Push(std::move(m_pBatch));
+  m_pBatch.reset(new Batch());
+}
+
+void HTPCParquetWriter::Close() {
+  if (!m_pQueue) return;
+
+  Flush();
+  m_pQueue.reset();
+
+  try {
+    PARQUET_THROW_NOT_OK(m_pStepsWriter->Close());
+    PARQUET_THROW_NOT_OK(m_pPrimariesWriter->Close());
+  } catch (const std::exception &hError) {
+    if (m_hError.empty()) m_hError = hError.what();
+  }
+
+  if (!m_hError.empty())
+    throw std::runtime_error("HTPCParquetWriter: " + m_hError);
+}
+
+void HTPCParquetWriter::Write(Batch &hBatch) {
+  // after a failure the remaining batches are dropped, Close() reports it
+  if (!m_hError.empty()) return;
+
+  try {
+    if (!hBatch.hEventId.empty()) {
+      std::shared_ptr<arrow::Table> pSteps = arrow::Table::Make(
+          StepsSchema(),
+          {MakeArray(hBatch.hEventId), MakeArray(hBatch.hTrackId),
+           MakeArray(hBatch.hParentId), MakeArray(hBatch.hType),
+           MakeArray(hBatch.hParentType), MakeArray(hBatch.hCreatorProcess),
+           MakeArray(hBatch.hDepositingProcess), MakeArray(hBatch.hX),
+           MakeArray(hBatch.hY), MakeArray(hBatch.hZ),
+           MakeArray(hBatch.hEnergyDeposited),
+           MakeArray(hBatch.hPreStepEnergy), MakeArray(hBatch.hPostStepEnergy),
+           MakeArray(hBatch.hTime)});
+      PARQUET_THROW_NOT_OK(
+          m_pStepsWriter->WriteTable(*pSteps, hBatch.hEventId.size()));
+    }
+
+    std::shared_ptr<arrow::Table> pPrimaries = arrow::Table::Make(
+        PrimariesSchema(),
+        {MakeArray(hBatch.hPrimaryEventId), MakeArray(hBatch.hPrimaryType),
+         MakeArray(hBatch.hPrimaryX), MakeArray(hBatch.hPrimaryY),
+         MakeArray(hBatch.hPrimaryZ), MakeArray(hBatch.hPrimaryCx),
+         MakeArray(hBatch.hPrimaryCy), MakeArray(hBatch.hPrimaryCz),
+         MakeArray(hBatch.hPrimaryE), MakeArray(hBatch.hPrimaryW),
+         MakeArray(hBatch.hTotalEnergy), MakeArray(hBatch.hNbSteps)});
+    PARQUET_THROW_NOT_OK(m_pPrimariesWriter->WriteTable(
+        *pPrimaries, hBatch.hPrimaryEventId.size()));
+  } catch (const std::exception &hError) {
+    m_hError = hError.what();
+  }
+}
+
+#endif
@@ -71,6 +71,16 @@ void HTPCParticleSource::SetGeneratorType(G4String genType)
       m_pGenerator = new Xenon1tAmBeGenerator();
       currentGenType = "ambe";
     }
+    else if (genType == "lightmap")
+    {
+      m_pGenerator = new HTPCLightMapGenerator();
+      currentGenType = "lightmap";
+    }
+    else if (genType == "phasespace")
+    {
+      m_pGenerator = new HTPCPhaseSpaceGenerator();
+      currentGenType = "phasespace";
+    }
     else
     {
       G4cout << "HTPCParticleSource: ERROR - Unknown particle generator type [ "
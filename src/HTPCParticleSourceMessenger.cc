@@ -107,10 +107,10 @@ HTPCParticleSourceMessenger::HTPCParticleSourceMessenger(
   // particle generator type
   m_pGeneratorCmd = new G4UIcmdWithAString("/xe/gun/generator", this);
   m_pGeneratorCmd->SetGuidance("Sets particle generator type.");
-  m_pGeneratorCmd->SetGuidance("[ generic | muon | decay0 | multivertex | ambe ]");
+  m_pGeneratorCmd->SetGuidance("[ generic | muon | decay0 | multivertex | ambe | lightmap | phasespace ]");
   m_pGeneratorCmd->SetParameterName("GenType", true, true);
   m_pGeneratorCmd->SetDefaultValue("generic");
-  m_pGeneratorCmd->SetCandidates("generic muon decay0 multivertex ambe");
+  m_pGeneratorCmd->SetCandidates("generic muon decay0 multivertex ambe lightmap phasespace");
 
   // source distribution type
   m_pTypeCmd = new G4UIcmdWithAString("/xe/gun/type", this);
@@ -239,6 +239,12 @@ HTPCParticleSourceMessenger::HTPCParticleSourceMessenger(
   m_pDecay0EventFromFileCmd->SetGuidance("Insert file with DECAY0 events");
   m_pDecay0EventFromFileCmd->SetParameterName("InputFileName", true, true);
 
+  m_pDecay0StartEventCmd = new G4UIcmdWithAnInteger("/xe/gun/decay0startevent", this);
+  m_pDecay0StartEventCmd->SetGuidance("First event of the DECAY0 file to simulate (counted from 0),");
+  m_pDecay0StartEventCmd->SetGuidance("e.g. job index times events per job for array jobs.");
+  m_pDecay0StartEventCmd->SetParameterName("event", false);
+  m_pDecay0StartEventCmd->SetRange("event >= 0");
+
   // FV MULTI PARTICLE input file  (3-position 3-direction KineticEnergy type)
   m_pMultiEventFromFileCmd =
     new G4UIcmdWithAString("/xe/gun/multieventfromfile", this);
@@ -246,6 +252,8 @@ HTPCParticleSourceMessenger::HTPCParticleSourceMessenger(
     "Insert file with multiple particles per event");
   m_pMultiEventFromFileCmd->SetGuidance(
     "3-position (cm), 3-direction,  KinEnergy (MeV) type (PDG)");
+  m_pMultiEventFromFileCmd->SetGuidance(
+    "or a binary file from htpcConvert multivertex (waveform generator)");
   m_pMultiEventFromFileCmd->SetParameterName("InputFileName", true, true);
 
   // EDIT PAOLO
@@ -253,7 +261,61 @@ HTPCParticleSourceMessenger::HTPCParticleSourceMessenger(
   m_pMuonsFromFileCmd = new G4UIcmdWithAString("/xe/gun/muonsfromfile", this);
   m_pMuonsFromFileCmd->SetGuidance("Insert file with the cosmic muon momentum");
   m_pMuonsFromFileCmd->SetGuidance("3-direction,  KinEnergy (MeV)");
+  m_pMuonsFromFileCmd->SetGuidance("or a binary file from htpcConvert muon");
   m_pMuonsFromFileCmd->SetParameterName("InputFileName", true, true);
+
+  m_pMuonStartRecordCmd = new G4UIcmdWithAnInteger("/xe/gun/muonstartrecord", this);
+  m_pMuonStartRecordCmd->SetGuidance("First muon of a binary muon file (counted from 0), by default");
+  m_pMuonStartRecordCmd->SetGuidance("a random one. Text files always start at a random line.");
+  m_pMuonStartRecordCmd->SetParameterName("record", false);
+  m_pMuonStartRecordCmd->SetRange("record >= 0");
+
+  m_pMuonSamplingCmd = new G4UIcmdWithAString("/xe/gun/muonsampling", this);
+  m_pMuonSamplingCmd->SetGuidance("Impact points of the muons: disk samples the 15 m disk orthogonal");
+  m_pMuonSamplingCmd->SetGuidance("to the muon direction, target only the muons crossing the bounding");
+  m_pMuonSamplingCmd->SetGuidance("cylinder of the target, weighted by the geometric acceptance.");
+  m_pMuonSamplingCmd->SetParameterName("mode", false);
+  m_pMuonSamplingCmd->SetCandidates("disk target");
+
+  m_pMuonTargetCmd = new G4UIcmdWithAString("/xe/gun/muontarget", this);
+  m_pMuonTargetCmd->SetGuidance("Physical volume whose bounding cylinder is the muon target,");
+  m_pMuonTargetCmd->SetGuidance("by default phys_oCryostat.");
+  m_pMuonTargetCmd->SetParameterName("volume", false);
+
+  m_pMuonTargetCylinderCmd = new G4UIcommand("/xe/gun/muontargetcylinder", this);
+  m_pMuonTargetCylinderCmd->SetGuidance("Vertical cylinder used as muon target instead of a volume:");
+  m_pMuonTargetCylinderCmd->SetGuidance("radius, half height and z of its centre.");
+  G4UIparameter *pTargetParam;
+  for (const char *szName : {"radius", "halfz", "z"})
+  {
+    pTargetParam = new G4UIparameter(szName, 'd', false);
+    m_pMuonTargetCylinderCmd->SetParameter(pTargetParam);
+  }
+  pTargetParam = new G4UIparameter("unit", 's', true);
+  pTargetParam->SetDefaultUnit("m");
+  m_pMuonTargetCylinderCmd->SetParameter(pTargetParam);
+
+  // particles recorded by /htpc/phasespace/ in a first stage (phasespace generator)
+  m_pPhaseSpaceFileCmd = new G4UIcmdWithAString("/xe/gun/phasespacefile", this);
+  m_pPhaseSpaceFileCmd->SetGuidance("Phase space file (<output file>.phasespace) of a first stage to replay.");
+  m_pPhaseSpaceFileCmd->SetParameterName("InputFileName", false);
+
+  m_pPhaseSpaceRotateCmd = new G4UIcmdWithABool("/xe/gun/phasespacerotate", this);
+  m_pPhaseSpaceRotateCmd->SetGuidance("Rotate every replayed event by a random angle around the z axis");
+  m_pPhaseSpaceRotateCmd->SetGuidance("(default false), for first stages symmetric around it.");
+  m_pPhaseSpaceRotateCmd->SetParameterName("rotate", false);
+
+  // grid of the light collection map calibration (lightmap generator)
+  m_pLightMapBinsCmd = new G4UIcommand("/xe/gun/lightmapbins", this);
+  m_pLightMapBinsCmd->SetGuidance("Number of voxels along x, y and z of the light map grid,");
+  m_pLightMapBinsCmd->SetGuidance("which spans /xe/gun/center +- (halfx, halfy, halfz).");
+  G4UIparameter *pBinsParam;
+  for (const char *szAxis : {"nx", "ny", "nz"})
+  {
+    pBinsParam = new G4UIparameter(szAxis, 'i', false);
+    pBinsParam->SetParameterRange((G4String(szAxis) + " > 0").c_str());
+    m_pLightMapBinsCmd->SetParameter(pBinsParam);
+  }
 }
 
 HTPCParticleSourceMessenger::~HTPCParticleSourceMessenger()
@@ -279,7 +341,15 @@ HTPCParticleSourceMessenger::~HTPCParticleSourceMessenger()
   delete m_pPositionCmd;
   delete m_pMultiEventFromFileCmd;
   delete m_pDecay0EventFromFileCmd;
+  delete m_pDecay0StartEventCmd;
   delete m_pMuonsFromFileCmd;
+  delete m_pMuonStartRecordCmd;
+  delete m_pMuonSamplingCmd;
+  delete m_pMuonTargetCmd;
+  delete m_pMuonTargetCylinderCmd;
+  delete m_pPhaseSpaceFileCmd;
+  delete m_pPhaseSpaceRotateCmd;
+  delete m_pLightMapBinsCmd;
   delete m_pDirectionCmd;
   delete m_pEnergyCmd;
   delete m_pListCmd;
@@ -445,6 +515,17 @@ void HTPCParticleSourceMessenger::SetNewValue(G4UIcommand *command,
       exit(-1);
     }
   }
+  else if (command == m_pDecay0StartEventCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("decay0"))
+      static_cast<Xenon1tDecay0Generator *>(m_pGen)->SetStartEvent(m_pDecay0StartEventCmd->GetNewIntValue(newValues));
+    else
+    {
+      G4cout << "Particle generator must be set to decay0 to set the start event: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
   else if (command == m_pMultiEventFromFileCmd)
   {
     if(m_pSource->ValidateGeneratorType("multivertex"))
@@ -460,6 +541,57 @@ void HTPCParticleSourceMessenger::SetNewValue(G4UIcommand *command,
       exit(-1);
     }
   }
+  else if (command == m_pMuonStartRecordCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("muon"))
+      static_cast<Xenon1tMuonGenerator *>(m_pGen)->SetStartRecord(m_pMuonStartRecordCmd->GetNewIntValue(newValues));
+    else
+    {
+      G4cout << "Particle generator must be set to muon to set the start record: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
+  else if (command == m_pMuonSamplingCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("muon"))
+      static_cast<Xenon1tMuonGenerator *>(m_pGen)->SetSamplingMode(newValues);
+    else
+    {
+      G4cout << "Particle generator must be set to muon to set the sampling: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
+  else if (command == m_pMuonTargetCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("muon"))
+      static_cast<Xenon1tMuonGenerator *>(m_pGen)->SetTargetVolume(newValues);
+    else
+    {
+      G4cout << "Particle generator must be set to muon to set the target: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
+  else if (command == m_pMuonTargetCylinderCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("muon"))
+    {
+      G4double dRadius, dHalfZ, dCenterZ;
+      G4String hUnit;
+      std::istringstream hStream(newValues);
+      hStream >> dRadius >> dHalfZ >> dCenterZ >> hUnit;
+      G4double dUnit = G4UIcommand::ValueOf(hUnit);
+      static_cast<Xenon1tMuonGenerator *>(m_pGen)->SetTargetCylinder(dRadius*dUnit, dHalfZ*dUnit, dCenterZ*dUnit);
+    }
+    else
+    {
+      G4cout << "Particle generator must be set to muon to set the target: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
   else if (command == m_pMuonsFromFileCmd)    // EDIT PAOLO
   {
     if(m_pSource->ValidateGeneratorType("muon"))
@@ -475,6 +607,48 @@ void HTPCParticleSourceMessenger::SetNewValue(G4UIcommand *command,
       exit(-1);
     }
   }
+  else if (command == m_pPhaseSpaceFileCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("phasespace"))
+    {
+      m_pGen->SetInputFileName(newValues);
+      G4cout << "INPUT: PHASE SPACE from file [ " << m_pGen->GetEventInputFileName()
+             << " ]" << G4endl;
+    }
+    else
+    {
+      G4cout << "Particle generator must be set to phasespace to use this input file: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
+  else if (command == m_pPhaseSpaceRotateCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("phasespace"))
+      static_cast<HTPCPhaseSpaceGenerator *>(m_pGen)->SetRotation(m_pPhaseSpaceRotateCmd->GetNewBoolValue(newValues));
+    else
+    {
+      G4cout << "Particle generator must be set to phasespace to rotate the events: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
+  else if (command == m_pLightMapBinsCmd)
+  {
+    if(m_pSource->ValidateGeneratorType("lightmap"))
+    {
+      G4int iNbBinsX, iNbBinsY, iNbBinsZ;
+      std::istringstream hStream(newValues);
+      hStream >> iNbBinsX >> iNbBinsY >> iNbBinsZ;
+      static_cast<HTPCLightMapGenerator *>(m_pGen)->SetNbBins(iNbBinsX, iNbBinsY, iNbBinsZ);
+    }
+    else
+    {
+      G4cout << "Particle generator must be set to lightmap to set the grid: [ "
+             << newValues << " ] !" << G4endl;
+      exit(-1);
+    }
+  }
   else if (command == m_pEnergyCmd)
   {
     m_pGen->SetEnergyDisType("Mono");
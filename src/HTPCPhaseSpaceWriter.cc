@@ -0,0 +1,51 @@
+#include "HTPCPhaseSpaceWriter.hh"
+
+#include <cstring>
+
+const char HTPCPhaseSpaceWriter::szMagic[9] = "HTPCPS02";
+const char HTPCPhaseSpaceWriter::szExposureTag[9] = "HTPCPSEX";
+
+HTPCPhaseSpaceWriter::HTPCPhaseSpaceWriter()
+    : m_hFile("HTPCPhaseSpaceWriter"),
+      m_iNbRecords(0),
+      m_iNbEvents(0),
+      m_dTotalWeight(0.) {}
+
+HTPCPhaseSpaceWriter::~HTPCPhaseSpaceWriter() {
+  try {
+    Close();
+  } catch (const std::exception &) {
+  }
+}
+
+void HTPCPhaseSpaceWriter::Open(const std::string &hFilename,
+                                size_t iBufferSize) {
+  Close();
+
+  m_hFile.Open(hFilename, iBufferSize);
+  m_hFile.Write(szMagic, 8);
+  m_iNbRecords = 0;
+  m_iNbEvents = 0;
+  m_dTotalWeight = 0.;
+}
+
+void HTPCPhaseSpaceWriter::Fill(const Record &hRecord) {
+  m_hFile.Write(&hRecord, sizeof(Record));
+  ++m_iNbRecords;
+}
+
+void HTPCPhaseSpaceWriter::AddEvent(double dWeight) {
+  ++m_iNbEvents;
+  m_dTotalWeight += dWeight;
+}
+
+void HTPCPhaseSpaceWriter::Close() {
+  if (!m_hFile.IsOpen()) return;
+
+  Exposure hExposure;
+  std::memcpy(hExposure.szTag, szExposureTag, 8);
+  hExposure.iNbEvents = m_iNbEvents;
+  hExposure.dWeight = m_dTotalWeight;
+  m_hFile.Write(&hExposure, sizeof(Exposure));
+  m_hFile.Close();
+}
@@ -1,10 +1,20 @@
 #include "HTPCPhysicsList.hh"
+#include "HTPCPhysicsListMessenger.hh"
 
 // Additional Header Files
 #include <globals.hh>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
+#include <sstream>
 #include <vector>
 
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 // Geant4 headers
 #include "G4SystemOfUnits.hh"
 #include "G4UnitsTable.hh"
@@ -31,6 +41,8 @@
 #include "G4IonElasticPhysics.hh"
 #include "G4IonINCLXXPhysics.hh"
 #include "G4IonPhysics.hh"
+#include "G4OpticalParameters.hh"
+#include "G4OpticalPhysics.hh"
 
 #include "G4EmLivermorePhysics.hh"
 #include "G4PhysListFactory.hh"
@@ -38,6 +50,53 @@
 #include "G4NuclideTable.hh"
 #include "G4VModularPhysicsList.hh"
 #include "G4BuilderType.hh"
+#include "G4EmParameters.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Material.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4Version.hh"
+
+namespace {
+
+// mkdir -p
+bool MakeDirectory(const G4String& hPath)
+{
+    for (size_t iPos = hPath.find('/', 1); ; iPos = hPath.find('/', iPos + 1)) {
+        G4String hPart = hPath.substr(0, iPos);
+        if (mkdir(hPart.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        if (iPos == G4String::npos) break;
+    }
+    return true;
+}
+
+int RemoveEntry(const char* szPath, const struct stat*, int, struct FTW*)
+{
+    return remove(szPath);
+}
+
+// rm -r
+void RemoveDirectory(const G4String& hPath)
+{
+    nftw(hPath.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// FNV-1a, stable across builds and platforms unlike std::hash
+G4String HashConfiguration(const G4String& hConfiguration)
+{
+    uint64_t iHash = 14695981039346656037ULL;
+    for (unsigned char c : hConfiguration) {
+        iHash ^= c;
+        iHash *= 1099511628211ULL;
+    }
+
+    std::ostringstream hKey;
+    hKey << std::hex << std::setw(16) << std::setfill('0') << iHash;
+    return hKey.str();
+}
+
+}  // namespace
 
 // ======================================================================
 // Helper: Safely Replace Physics Constructor
@@ -81,6 +140,9 @@ HTPCPhysicsList::HTPCPhysicsList()
     // Enable diagnostic output
     VerboseLevel = 0;
     OpVerbLevel = 0;
+    OpticalPhysicsModel = nullptr;
+    m_bCerenkov = true;
+    m_bStoreTableCache = false;
     SetVerboseLevel(VerboseLevel);
 
     G4cout << "\n\n=====================================================\n";
@@ -122,6 +184,15 @@ HTPCPhysicsList::HTPCPhysicsList()
                << " (type=" << pc->GetPhysicsType() << ")\n";
     }
     G4cout << G4endl;
+
+    // ------------------------------------------------------------------
+    // Region cuts: fine tracking in the xenon, coarse in the vessels
+    // (regions are defined in HTPCDetectorConstruction::DefineRegions)
+    // ------------------------------------------------------------------
+    SetRegionCut("ActiveXe", "all", 0.1 * mm);
+    SetRegionCut("Shield", "all", 10. * mm);
+
+    m_pMessenger = new HTPCPhysicsListMessenger(this);
 }
 
 
@@ -163,6 +234,18 @@ void HTPCPhysicsList::SetHadronicModel(G4String name)
 {
     G4cout << "HTPCPhysicsList::SetHadronicModel(): switching to " << name << "\n";
 
+    // no hadronic physics at all, e.g. for gamma screening
+    if (name == "none") {
+        RemovePhysicsOfType(bHadronInelastic);
+        RemovePhysicsOfType(bHadronElastic);
+        G4cout << "Hadronic elastic and inelastic physics removed.\n" << G4endl;
+        return;
+    }
+
+    // restore the elastic part if it was removed before
+    if (!GetPhysicsWithType(bHadronElastic))
+        RegisterPhysics(new G4HadronElasticPhysicsHP(VerboseLevel));
+
     G4VPhysicsConstructor* had = nullptr;
 
     if (name == "QGSP_BIC_HP")
@@ -199,6 +282,75 @@ void HTPCPhysicsList::SetHadronicModel(G4String name)
 }
 
 
+// ======================================================================
+// Optional Constructors
+// ======================================================================
+void HTPCPhysicsList::SetOpticalPhysics(G4bool bEnable)
+{
+    G4cout << "HTPCPhysicsList::SetOpticalPhysics(): "
+           << (bEnable ? "on" : "off") << G4endl;
+
+    if (bEnable && !OpticalPhysicsModel) {
+        OpticalPhysicsModel = new G4OpticalPhysics(OpVerbLevel);
+        RegisterPhysics(OpticalPhysicsModel);
+        SetCerenkov(m_bCerenkov);
+    }
+    else if (!bEnable && OpticalPhysicsModel) {
+        RemovePhysics(OpticalPhysicsModel);
+        delete OpticalPhysicsModel;
+        OpticalPhysicsModel = nullptr;
+    }
+}
+
+void HTPCPhysicsList::SetCerenkov(G4bool useCerenkov)
+{
+    m_bCerenkov = useCerenkov;
+
+    // only has an effect together with the optical physics
+    G4OpticalParameters::Instance()->SetProcessActivation("Cerenkov", m_bCerenkov);
+}
+
+void HTPCPhysicsList::SetEmExtraPhysics(G4bool bEnable)
+{
+    G4cout << "HTPCPhysicsList::SetEmExtraPhysics(): "
+           << (bEnable ? "on" : "off") << G4endl;
+
+    if (!bEnable)
+        RemovePhysicsOfType(bEmExtra);
+    else if (!GetPhysicsWithType(bEmExtra))
+        RegisterPhysics(new G4EmExtraPhysics(VerboseLevel));
+}
+
+void HTPCPhysicsList::SetStoppingPhysics(G4bool bEnable)
+{
+    G4cout << "HTPCPhysicsList::SetStoppingPhysics(): "
+           << (bEnable ? "on" : "off") << G4endl;
+
+    if (!bEnable)
+        RemovePhysicsOfType(bStopping);
+    else if (!GetPhysicsWithType(bStopping))
+        RegisterPhysics(new G4StoppingPhysics(VerboseLevel));
+}
+
+void HTPCPhysicsList::RemovePhysicsOfType(G4int iType)
+{
+    // RemovePhysics only drops the constructors from the list
+    vector<const G4VPhysicsConstructor*> hRemoved;
+    for (G4int i = 0; ; ++i) {
+        const G4VPhysicsConstructor* pc = GetPhysics(i);
+        if (!pc) break;
+        if (pc->GetPhysicsType() == iType) hRemoved.push_back(pc);
+    }
+
+    RemovePhysics(iType);
+
+    for (const G4VPhysicsConstructor* pc : hRemoved) {
+        G4cout << "  removed " << pc->GetPhysicsName() << "\n";
+        delete pc;
+    }
+}
+
+
 // ======================================================================
 // SET CUTS
 // ======================================================================
@@ -215,6 +367,26 @@ void HTPCPhysicsList::SetCuts()
     G4cout << "  Cut e+:     " << GetCutValue("e+") / mm << " mm\n";
     G4cout << "  Cut proton: " << GetCutValue("proton") / mm << " mm\n";
 
+    ApplyRegionCuts();
+
+    if (!m_hTableCacheDirectory.empty()) {
+        m_hTableCacheKey = HashConfiguration(GetTableCacheConfiguration());
+        G4String hDirectory = m_hTableCacheDirectory + "/" + m_hTableCacheKey;
+
+        struct stat hStat;
+        if (stat((hDirectory + "/complete").c_str(), &hStat) == 0) {
+            G4cout << "  Retrieving physics tables from " << hDirectory << "\n";
+            SetPhysicsTableRetrieved(hDirectory);
+            m_bStoreTableCache = false;
+        }
+        else {
+            G4cout << "  No cached physics tables for this configuration, they will be\n"
+                   << "  stored in " << hDirectory << " once built\n";
+            ResetPhysicsTableRetrieved();
+            m_bStoreTableCache = true;
+        }
+    }
+
     G4cout << "\nDumping Production Cuts Table:\n";
     DumpCutValuesTable();
 
@@ -223,4 +395,183 @@ void HTPCPhysicsList::SetCuts()
 
 
 // ======================================================================
-HTPCPhysicsList::~HTPCPhysicsList() {}
+// Region Cuts and EM Models
+// ======================================================================
+void HTPCPhysicsList::SetRegionCut(const G4String& hRegion,
+                                   const G4String& hParticle,
+                                   G4double dCut)
+{
+    if (hParticle == "all") {
+        for (const char* szParticle : {"gamma", "e-", "e+", "proton"})
+            m_hRegionCuts[hRegion][szParticle] = dCut;
+    }
+    else {
+        m_hRegionCuts[hRegion][hParticle] = dCut;
+    }
+
+    // After initialisation the regions exist and the change is picked up
+    // at the next /run/beamOn
+    if (G4RegionStore::GetInstance()->GetRegion(hRegion, false))
+        ApplyRegionCuts();
+}
+
+void HTPCPhysicsList::ApplyRegionCuts()
+{
+    G4ProductionCuts* pDefaultCuts =
+        G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+
+    for (const auto& hRegionCuts : m_hRegionCuts) {
+        G4Region* pRegion = G4RegionStore::GetInstance()->GetRegion(hRegionCuts.first, false);
+        if (!pRegion) {
+            G4Exception("HTPCPhysicsList::ApplyRegionCuts",
+                        "PhysicsList", JustWarning,
+                        ("Region " + hRegionCuts.first + " is not defined.").c_str());
+            continue;
+        }
+
+        // Regions without their own cuts share the default object, which must
+        // not be modified
+        G4ProductionCuts* pCuts = pRegion->GetProductionCuts();
+        if (!pCuts || pCuts == pDefaultCuts) {
+            pCuts = new G4ProductionCuts(*pDefaultCuts);
+            pRegion->SetProductionCuts(pCuts);
+        }
+
+        for (const auto& hCut : hRegionCuts.second) {
+            pCuts->SetProductionCut(hCut.second, hCut.first);
+            G4cout << "  Region " << hRegionCuts.first << ": cut " << hCut.first
+                   << " = " << hCut.second / mm << " mm\n";
+        }
+    }
+}
+
+void HTPCPhysicsList::SetRegionEmModel(const G4String& hRegion,
+                                       const G4String& hModel)
+{
+    // Applied by G4EmModelActivator (through G4EmConfigurator) when the EM
+    // processes are constructed, so this only works before initialisation
+    G4String hPhysics;
+    if (hModel == "livermore")
+        hPhysics = "G4EmLivermore";
+    else if (hModel == "penelope")
+        hPhysics = "G4EmPenelope";
+    else
+        G4Exception("HTPCPhysicsList::SetRegionEmModel",
+                    "PhysicsList", FatalException,
+                    "Invalid EM model choice.");
+
+    G4cout << "HTPCPhysicsList::SetRegionEmModel(): " << hPhysics
+           << " in region " << hRegion << G4endl;
+
+    G4EmParameters::Instance()->AddPhysics(hRegion, hPhysics);
+}
+
+
+// ======================================================================
+// Physics Table Cache
+// ======================================================================
+void HTPCPhysicsList::SetPhysicsTableCache(const G4String& hDirectory)
+{
+    m_hTableCacheDirectory = (hDirectory == "none") ? G4String("") : hDirectory;
+
+    // strip trailing slashes, the key is appended as a subdirectory
+    while (m_hTableCacheDirectory.size() > 1 && m_hTableCacheDirectory.back() == '/')
+        m_hTableCacheDirectory.pop_back();
+
+    G4cout << "HTPCPhysicsList::SetPhysicsTableCache(): "
+           << (m_hTableCacheDirectory.empty() ? G4String("disabled") : m_hTableCacheDirectory)
+           << G4endl;
+}
+
+G4String HTPCPhysicsList::GetTableCacheConfiguration() const
+{
+    // everything the stored tables depend on: the constructors, the cuts of
+    // every region, the materials (couples) and the EM options
+    std::ostringstream hConfiguration;
+    hConfiguration << std::setprecision(10);
+
+    hConfiguration << "geant4 " << G4VERSION_NUMBER << "\n";
+
+    for (G4int i = 0; ; ++i) {
+        const G4VPhysicsConstructor* pc = GetPhysics(i);
+        if (!pc) break;
+        hConfiguration << "physics " << pc->GetPhysicsName()
+                       << " " << pc->GetPhysicsType() << "\n";
+    }
+
+    G4ProductionCutsTable* pCutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+    hConfiguration << "energyRange " << pCutsTable->GetLowEdgeEnergy() / eV
+                   << " " << pCutsTable->GetHighEdgeEnergy() / eV << "\n";
+
+    for (const G4Region* pRegion : *G4RegionStore::GetInstance()) {
+        hConfiguration << "region " << pRegion->GetName();
+        const G4ProductionCuts* pCuts = pRegion->GetProductionCuts();
+        if (pCuts)
+            for (G4int iIndex = 0; iIndex < NumberOfG4CutIndex; ++iIndex)
+                hConfiguration << " " << pCuts->GetProductionCut(iIndex) / mm;
+        hConfiguration << "\n";
+    }
+
+    for (const G4Material* pMaterial : *G4Material::GetMaterialTable())
+        hConfiguration << "material " << pMaterial->GetName() << " "
+                       << pMaterial->GetDensity() / (g / cm3) << " "
+                       << pMaterial->GetNumberOfElements() << "\n";
+
+    hConfiguration << *G4EmParameters::Instance();
+
+    return hConfiguration.str();
+}
+
+void HTPCPhysicsList::StorePhysicsTableCache()
+{
+    if (!m_bStoreTableCache) return;
+    m_bStoreTableCache = false;
+
+    // cuts changed after initialisation end up under their own key
+    G4String hConfiguration = GetTableCacheConfiguration();
+    m_hTableCacheKey = HashConfiguration(hConfiguration);
+
+    G4String hDirectory = m_hTableCacheDirectory + "/" + m_hTableCacheKey;
+
+    // write into a private directory and rename it into place, so that jobs
+    // starting at the same time never pick up a partial set of tables
+    G4String hTemporary = hDirectory + ".tmp." + std::to_string(getpid());
+
+    if (!MakeDirectory(m_hTableCacheDirectory) || mkdir(hTemporary.c_str(), 0755) != 0) {
+        G4Exception("HTPCPhysicsList::StorePhysicsTableCache",
+                    "PhysicsList", JustWarning,
+                    ("Cannot create " + hTemporary + ", physics tables not cached.").c_str());
+        return;
+    }
+
+    G4cout << "HTPCPhysicsList: storing physics tables in " << hDirectory << G4endl;
+
+    if (!StorePhysicsTable(hTemporary)) {
+        G4Exception("HTPCPhysicsList::StorePhysicsTableCache",
+                    "PhysicsList", JustWarning,
+                    "Storing the physics tables failed, they are not cached.");
+        RemoveDirectory(hTemporary);
+        return;
+    }
+
+    std::ofstream hConfigurationFile(hTemporary + "/configuration.txt");
+    hConfigurationFile << hConfiguration;
+    hConfigurationFile.close();
+
+    // written last, marks the set as usable
+    std::ofstream hMarker(hTemporary + "/complete");
+    hMarker.close();
+
+    if (rename(hTemporary.c_str(), hDirectory.c_str()) != 0) {
+        // another job got there first, its tables are equivalent
+        G4cout << "HTPCPhysicsList: " << hDirectory << " already exists" << G4endl;
+        RemoveDirectory(hTemporary);
+    }
+}
+
+
+// ======================================================================
+HTPCPhysicsList::~HTPCPhysicsList()
+{
+    delete m_pMessenger;
+}
@@ -0,0 +1,154 @@
+#include "HTPCPhysicsListMessenger.hh"
+#include <sstream>
+#include "HTPCPhysicsList.hh"
+
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcommand.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIparameter.hh"
+#include "globals.hh"
+
+HTPCPhysicsListMessenger::HTPCPhysicsListMessenger(
+  HTPCPhysicsList* pPhysicsList)
+  : m_pPhysicsList(pPhysicsList)
+{
+  m_pDirectory = new G4UIdirectory("/htpc/physics/");
+  m_pDirectory->SetGuidance("Physics list control commands.");
+
+  m_pRegionCutCmd = new G4UIcommand("/htpc/physics/regionCut", this);
+  m_pRegionCutCmd->SetGuidance("Set the production cut of a region (ActiveXe, InnerDetector, Shield)");
+  m_pRegionCutCmd->SetGuidance("for all particles or for one of gamma, e-, e+, proton.");
+  m_pRegionCutCmd->SetGuidance("The Lab (world) uses the default cuts, see /run/setCut.");
+
+  G4UIparameter* pRegionParam = new G4UIparameter("region", 's', false);
+  m_pRegionCutCmd->SetParameter(pRegionParam);
+
+  G4UIparameter* pCutParam = new G4UIparameter("cut", 'd', false);
+  pCutParam->SetParameterRange("cut > 0.");
+  m_pRegionCutCmd->SetParameter(pCutParam);
+
+  G4UIparameter* pUnitParam = new G4UIparameter("unit", 's', true);
+  pUnitParam->SetDefaultValue("mm");
+  pUnitParam->SetParameterCandidates(G4UIcommand::UnitsList("Length"));
+  m_pRegionCutCmd->SetParameter(pUnitParam);
+
+  G4UIparameter* pParticleParam = new G4UIparameter("particle", 's', true);
+  pParticleParam->SetDefaultValue("all");
+  pParticleParam->SetParameterCandidates("all gamma e- e+ proton");
+  m_pRegionCutCmd->SetParameter(pParticleParam);
+
+  m_pRegionCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  m_pRegionEmModelCmd = new G4UIcommand("/htpc/physics/regionEmModel", this);
+  m_pRegionEmModelCmd->SetGuidance("Use Livermore or Penelope low-energy EM models in one region,");
+  m_pRegionEmModelCmd->SetGuidance("on top of the EM constructor of the physics list.");
+
+  G4UIparameter* pEmRegionParam = new G4UIparameter("region", 's', false);
+  m_pRegionEmModelCmd->SetParameter(pEmRegionParam);
+
+  G4UIparameter* pModelParam = new G4UIparameter("model", 's', false);
+  pModelParam->SetParameterCandidates("livermore penelope");
+  m_pRegionEmModelCmd->SetParameter(pModelParam);
+
+  m_pRegionEmModelCmd->AvailableForStates(G4State_PreInit);
+
+  m_pTableCacheCmd = new G4UIcmdWithAString("/htpc/physics/tableCache", this);
+  m_pTableCacheCmd->SetGuidance("Cache the physics tables in a subdirectory of this directory,");
+  m_pTableCacheCmd->SetGuidance("keyed on the physics configuration, cuts and materials.");
+  m_pTableCacheCmd->SetGuidance("Tables are retrieved when a matching set exists, otherwise");
+  m_pTableCacheCmd->SetGuidance("they are stored at the start of the first run. none disables.");
+  m_pTableCacheCmd->SetParameterName("directory", false);
+  m_pTableCacheCmd->AvailableForStates(G4State_PreInit);
+
+  // constructor selection, has to be done in the -p pre-init macro
+  m_pEmModelCmd = new G4UIcmdWithAString("/htpc/physics/emModel", this);
+  m_pEmModelCmd->SetGuidance("Select the EM physics constructor.");
+  m_pEmModelCmd->SetParameterName("model", false);
+  m_pEmModelCmd->SetCandidates("emstandard emlivermore empenelope");
+  m_pEmModelCmd->AvailableForStates(G4State_PreInit);
+
+  m_pHadronicModelCmd = new G4UIcmdWithAString("/htpc/physics/hadronicModel", this);
+  m_pHadronicModelCmd->SetGuidance("Select the hadronic inelastic constructor (HP elastic is kept),");
+  m_pHadronicModelCmd->SetGuidance("none removes hadronic elastic and inelastic physics.");
+  m_pHadronicModelCmd->SetParameterName("model", false);
+  m_pHadronicModelCmd->SetCandidates("QGSP_BERT QGSP_BERT_HP QGSP_BIC QGSP_BIC_HP FTFP_BERT_HP QBBC INCLXX Shielding none");
+  m_pHadronicModelCmd->AvailableForStates(G4State_PreInit);
+
+  m_pOpticalCmd = new G4UIcmdWithABool("/htpc/physics/optical", this);
+  m_pOpticalCmd->SetGuidance("Register G4OpticalPhysics (off by default).");
+  m_pOpticalCmd->SetParameterName("optical", false);
+  m_pOpticalCmd->AvailableForStates(G4State_PreInit);
+
+  m_pCerenkovCmd = new G4UIcmdWithABool("/htpc/physics/cerenkov", this);
+  m_pCerenkovCmd->SetGuidance("Cerenkov light production with the optical physics.");
+  m_pCerenkovCmd->SetParameterName("cerenkov", false);
+  m_pCerenkovCmd->AvailableForStates(G4State_PreInit);
+
+  m_pEmExtraCmd = new G4UIcmdWithABool("/htpc/physics/emExtra", this);
+  m_pEmExtraCmd->SetGuidance("Register G4EmExtraPhysics (gamma- and electro-nuclear, on by default).");
+  m_pEmExtraCmd->SetParameterName("emExtra", false);
+  m_pEmExtraCmd->AvailableForStates(G4State_PreInit);
+
+  m_pStoppingCmd = new G4UIcmdWithABool("/htpc/physics/stopping", this);
+  m_pStoppingCmd->SetGuidance("Register G4StoppingPhysics (capture at rest, on by default).");
+  m_pStoppingCmd->SetParameterName("stopping", false);
+  m_pStoppingCmd->AvailableForStates(G4State_PreInit);
+}
+
+HTPCPhysicsListMessenger::~HTPCPhysicsListMessenger()
+{
+  delete m_pRegionCutCmd;
+  delete m_pRegionEmModelCmd;
+  delete m_pTableCacheCmd;
+  delete m_pEmModelCmd;
+  delete m_pHadronicModelCmd;
+  delete m_pOpticalCmd;
+  delete m_pCerenkovCmd;
+  delete m_pEmExtraCmd;
+  delete m_pStoppingCmd;
+  delete m_pDirectory;
+}
+
+void HTPCPhysicsListMessenger::SetNewValue(G4UIcommand* command,
+    G4String newValue)
+{
+  std::istringstream hStream(newValue);
+
+  if (command == m_pRegionCutCmd)
+  {
+    G4String hRegion, hUnit, hParticle;
+    G4double dCut;
+    hStream >> hRegion >> dCut >> hUnit >> hParticle;
+    m_pPhysicsList->SetRegionCut(hRegion, hParticle,
+                                 dCut * G4UIcommand::ValueOf(hUnit));
+  }
+
+  if (command == m_pRegionEmModelCmd)
+  {
+    G4String hRegion, hModel;
+    hStream >> hRegion >> hModel;
+    m_pPhysicsList->SetRegionEmModel(hRegion, hModel);
+  }
+
+  if (command == m_pTableCacheCmd)
+    m_pPhysicsList->SetPhysicsTableCache(newValue);
+
+  if (command == m_pEmModelCmd)
+    m_pPhysicsList->SetEMlowEnergyModel(newValue);
+
+  if (command == m_pHadronicModelCmd)
+    m_pPhysicsList->SetHadronicModel(newValue);
+
+  if (command == m_pOpticalCmd)
+    m_pPhysicsList->SetOpticalPhysics(G4UIcmdWithABool::GetNewBoolValue(newValue));
+
+  if (command == m_pCerenkovCmd)
+    m_pPhysicsList->SetCerenkov(G4UIcmdWithABool::GetNewBoolValue(newValue));
+
+  if (command == m_pEmExtraCmd)
+    m_pPhysicsList->SetEmExtraPhysics(G4UIcmdWithABool::GetNewBoolValue(newValue));
+
+  if (command == m_pStoppingCmd)
+    m_pPhysicsList->SetStoppingPhysics(G4UIcmdWithABool::GetNewBoolValue(newValue));
+}
@@ -0,0 +1,94 @@
+#include "HTPCPrimaryTable.hh"
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+const char szMagic[8] = {'H', 'T', 'P', 'C', 'P', 'V', '0', '1'};
+const size_t iNbFloats = 8;
+
+}  // namespace
+
+HTPCPrimaryTable::HTPCPrimaryTable()
+    : m_hFile("HTPCPrimaryTable"), m_iPreviousEventId(-1), m_iNbRecords(0) {}
+
+void HTPCPrimaryTable::Open(const std::string &hFilename,
+                            size_t iBufferSize) {
+  Close();
+
+  m_hFile.Open(hFilename, iBufferSize);
+  m_hFile.Write(szMagic, sizeof(szMagic));
+  m_iPreviousEventId = -1;
+  m_iNbRecords = 0;
+}
+
+void HTPCPrimaryTable::Fill(const Record &hRecord) {
+  if (hRecord.iEventId < m_iPreviousEventId)
+    throw std::invalid_argument("HTPCPrimaryTable: event ids in " +
+                                m_hFile.GetFilename() + " must not decrease");
+
+  uint64_t iDelta = hRecord.iEventId - m_iPreviousEventId;
+  m_iPreviousEventId = hRecord.iEventId;
+  char pcDelta[10];
+  size_t iNbBytes = 0;
+  while (iDelta >= 0x80) {
+    pcDelta[iNbBytes++] = static_cast<char>((iDelta & 0x7f) | 0x80);
+    iDelta >>= 7;
+  }
+  pcDelta[iNbBytes++] = static_cast<char>(iDelta);
+  m_hFile.Write(pcDelta, iNbBytes);
+
+  const float pfValues[iNbFloats] = {
+      hRecord.fX,  hRecord.fY,  hRecord.fZ,      hRecord.fCx,
+      hRecord.fCy, hRecord.fCz, hRecord.fEnergy, hRecord.fWeight};
+  m_hFile.Write(pfValues, sizeof(pfValues));
+  ++m_iNbRecords;
+}
+
+void HTPCPrimaryTable::Close() { m_hFile.Close(); }
+
+void HTPCPrimaryTable::Read(const std::string &hFilename,
+                            std::vector<Record> &hRecords) {
+  std::ifstream hFile(hFilename.c_str(), std::ios::binary);
+  if (!hFile)
+    throw std::runtime_error("HTPCPrimaryTable: cannot open " + hFilename);
+
+  std::vector<char> hBytes((std::istreambuf_iterator<char>(hFile)),
+                           std::istreambuf_iterator<char>());
+  if (hBytes.size() < sizeof(szMagic) ||
+      std::memcmp(&hBytes[0], szMagic, sizeof(szMagic)))
+    throw std::runtime_error("HTPCPrimaryTable: " + hFilename +
+                             " is not a primary table");
+
+  hRecords.clear();
+  int64_t iEventId = -1;
+  size_t iPosition = sizeof(szMagic);
+  while (iPosition < hBytes.size()) {
+    uint64_t iDelta = 0;
+    unsigned iShift = 0;
+    unsigned char iByte;
+    do {
+      if (iPosition >= hBytes.size() || iShift > 63)
+        throw std::runtime_error("HTPCPrimaryTable: " + hFilename +
+                                 " is truncated");
+      iByte = static_cast<unsigned char>(hBytes[iPosition++]);
+      iDelta |= static_cast<uint64_t>(iByte & 0x7f) << iShift;
+      iShift += 7;
+    } while (iByte & 0x80);
+
+    float pfValues[iNbFloats];
+    if (hBytes.size() - iPosition < sizeof(pfValues))
+      throw std::runtime_error("HTPCPrimaryTable: " + hFilename +
+                               " is truncated");
+    std::memcpy(pfValues, &hBytes[iPosition], sizeof(pfValues));
+    iPosition += sizeof(pfValues);
+
+    iEventId += iDelta;
+    Record hRecord = {iEventId,    pfValues[0], pfValues[1],
+                      pfValues[2], pfValues[3], pfValues[4],
+                      pfValues[5], pfValues[6], pfValues[7]};
+    hRecords.push_back(hRecord);
+  }
+}
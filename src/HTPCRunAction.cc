@@ -5,17 +5,23 @@
 #include "G4VVisManager.hh"
 #include "G4Threading.hh"
 #include "HTPCAnalysisManager.hh"
+#include "HTPCPhysicsList.hh"
 #include "HTPCRunAction.hh"
 #include "TRandom3.h"
 
-HTPCRunAction::HTPCRunAction(HTPCAnalysisManager *pAnalysisManager) {
+HTPCRunAction::HTPCRunAction(HTPCAnalysisManager *pAnalysisManager,
+                             HTPCPhysicsList *pPhysicsList) {
   m_hRanSeed = 0;  // default value
   m_pAnalysisManager = pAnalysisManager;
+  m_pPhysicsList = pPhysicsList;
 }
 
 HTPCRunAction::~HTPCRunAction() { }
 
 void HTPCRunAction::BeginOfRunAction(const G4Run *pRun) {
+  // the physics tables have just been built, cache them if requested
+  if (m_pPhysicsList) m_pPhysicsList->StorePhysicsTableCache();
+
   if (m_pAnalysisManager) {
     m_pAnalysisManager->BeginOfRun(pRun);
   }
@@ -0,0 +1,131 @@
+#include "HTPCSignalSynthesis.hh"
+
+#include <G4SystemOfUnits.hh>
+#include <G4Poisson.hh>
+#include <Randomize.hh>
+
+#include <cmath>
+
+namespace {
+
+// average energy to produce a quantum in liquid xenon
+const G4double dWorkFunction = 13.7*eV;
+
+// excitons per ion
+const G4double dExcitonRatioER = 0.06;
+const G4double dExcitonRatioNR = 1.0;
+
+G4int Binomial(G4int iTrials, G4double dProbability)
+{
+  if(iTrials <= 0 || dProbability <= 0.) return 0;
+  if(dProbability >= 1.) return iTrials;
+  return (G4int) CLHEP::RandBinomial::shoot(iTrials, dProbability);
+}
+
+}  // namespace
+
+HTPCSignalSynthesis::HTPCSignalSynthesis() :
+  m_dG1(0.15), m_dSingleElectronGain(25.), m_dExtractionEfficiency(0.9),
+  m_dDriftVelocity(1.5*mm/microsecond), m_dElectronLifetime(5.*millisecond),
+  m_dRecombinationER(0.4), m_dRecombinationNR(0.6), m_dClusterScale(10.*mm),
+  m_dLiquidLevel(0.)
+{
+}
+
+G4double
+HTPCSignalSynthesis::LindhardFactor(G4double dEnergy)
+{
+  const G4double dK = 0.166;
+  const G4double dEpsilon = 11.5 * dEnergy/keV * std::pow(54., -7./3.);
+  const G4double dG = 3.*std::pow(dEpsilon, 0.15) + 0.7*std::pow(dEpsilon, 0.6) + dEpsilon;
+
+  return dK*dG / (1. + dK*dG);
+}
+
+G4double
+HTPCSignalSynthesis::GetMeanNbPhotons(G4double dEnergy, G4bool bNuclearRecoil) const
+{
+  if(dEnergy <= 0.) return 0.;
+
+  const G4double dExcitonRatio = bNuclearRecoil ? dExcitonRatioNR : dExcitonRatioER;
+  const G4double dRecombination = bNuclearRecoil ? m_dRecombinationNR : m_dRecombinationER;
+  if(bNuclearRecoil)
+    dEnergy *= LindhardFactor(dEnergy);
+
+  const G4double dIonFraction = 1./(1. + dExcitonRatio);
+  return dEnergy/dWorkFunction * (1. - dIonFraction + dIonFraction*dRecombination);
+}
+
+void
+HTPCSignalSynthesis::SampleQuanta(G4double dEnergy, G4double dExcitonRatio, G4double dRecombination,
+                                  G4int &iNbPhotons, G4int &iNbElectrons) const
+{
+  iNbPhotons = iNbElectrons = 0;
+  if(dEnergy <= 0.) return;
+
+  G4int iNbQuanta = (G4int) G4Poisson(dEnergy/dWorkFunction);
+  G4int iNbIons = Binomial(iNbQuanta, 1./(1. + dExcitonRatio));
+  G4int iNbRecombined = Binomial(iNbIons, dRecombination);
+
+  iNbPhotons = iNbQuanta - iNbIons + iNbRecombined;
+  iNbElectrons = iNbIons - iNbRecombined;
+}
+
+void
+HTPCSignalSynthesis::Process(const vector<Deposit> &hDeposits, vector<Cluster> &hClusters) const
+{
+  hClusters.clear();
+
+  // sequential clustering, as the post-processing does
+  vector<G4int> hNbDeposits;
+  G4ThreeVector hPrevious;
+  for(size_t i = 0; i < hDeposits.size(); i++)
+    {
+      const Deposit &hDeposit = hDeposits[i];
+      if(hDeposit.dEnergy <= 0.) continue;
+
+      if(hClusters.empty() || (hDeposit.hPosition - hPrevious).mag() >= m_dClusterScale)
+        {
+          Cluster hCluster;
+          hCluster.hPosition = G4ThreeVector();
+          hCluster.dEnergy = hCluster.dNuclearRecoilEnergy = 0.;
+          hClusters.push_back(hCluster);
+          hNbDeposits.push_back(0);
+        }
+      hPrevious = hDeposit.hPosition;
+
+      Cluster &hCluster = hClusters.back();
+      hCluster.hPosition += hDeposit.hPosition;
+      hCluster.dEnergy += hDeposit.dEnergy;
+      if(hDeposit.bNuclearRecoil)
+        hCluster.dNuclearRecoilEnergy += hDeposit.dEnergy;
+      hNbDeposits.back()++;
+    }
+
+  for(size_t i = 0; i < hClusters.size(); i++)
+    {
+      Cluster &hCluster = hClusters[i];
+      hCluster.hPosition /= hNbDeposits[i];
+
+      const G4double dNuclearRecoilEnergy = hCluster.dNuclearRecoilEnergy;
+      const G4double dElectronRecoilEnergy = hCluster.dEnergy - dNuclearRecoilEnergy;
+
+      G4int iNbPhotonsER, iNbElectronsER, iNbPhotonsNR, iNbElectronsNR;
+      SampleQuanta(dElectronRecoilEnergy, dExcitonRatioER, m_dRecombinationER,
+                   iNbPhotonsER, iNbElectronsER);
+      SampleQuanta(dNuclearRecoilEnergy*LindhardFactor(dNuclearRecoilEnergy),
+                   dExcitonRatioNR, m_dRecombinationNR, iNbPhotonsNR, iNbElectronsNR);
+      hCluster.iNbPhotons = iNbPhotonsER + iNbPhotonsNR;
+      hCluster.iNbElectrons = iNbElectronsER + iNbElectronsNR;
+
+      hCluster.dS1 = Binomial(hCluster.iNbPhotons, m_dG1);
+
+      // electrons drift up to the liquid level
+      const G4double dDriftLength = m_dLiquidLevel - hCluster.hPosition.z();
+      hCluster.dDriftTime = (dDriftLength > 0.) ? dDriftLength/m_dDriftVelocity : 0.;
+
+      G4double dSurvival = (m_dElectronLifetime > 0.) ? std::exp(-hCluster.dDriftTime/m_dElectronLifetime) : 1.;
+      G4int iNbExtracted = Binomial(Binomial(hCluster.iNbElectrons, dSurvival), m_dExtractionEfficiency);
+      hCluster.dS2 = (iNbExtracted > 0) ? G4Poisson(iNbExtracted*m_dSingleElectronGain) : 0.;
+    }
+}
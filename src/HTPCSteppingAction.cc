@@ -1,6 +1,7 @@
 #include "HTPCSteppingAction.hh"
 #include "HTPCAnalysisManager.hh"
 
+#include "G4OpticalPhoton.hh"
 #include "G4SteppingManager.hh"
 
 #include <string.h>
@@ -12,6 +13,35 @@ HTPCSteppingAction::HTPCSteppingAction(HTPCAnalysisManager *myAM):myAnalysisMana
 
 void HTPCSteppingAction::UserSteppingAction(const G4Step* aStep)
 {
+    // light map calibration: a photon entering a PMT window is counted for
+    // that PMT (copy number of the window's mother) and stopped there
+    if (myAnalysisManager && myAnalysisManager->IsLightMapCalibration()
+        && aStep->GetTrack()->GetDefinition() == G4OpticalPhoton::Definition())
+    {
+        const G4StepPoint* pPostStepPoint = aStep->GetPostStepPoint();
+        if (pPostStepPoint->GetStepStatus() == fGeomBoundary
+            && pPostStepPoint->GetPhysicalVolume() == myAnalysisManager->GetPMTWindow())
+        {
+            myAnalysisManager->AddDetectedPhoton(pPostStepPoint->GetTouchable()->GetCopyNumber(1));
+            aStep->GetTrack()->SetTrackStatus(fStopAndKill);
+        }
+        return;
+    }
+
+    // first stage of a two-stage simulation: particles entering the phase
+    // space volume are recorded and usually stopped there
+    if (myAnalysisManager && myAnalysisManager->GetPhaseSpaceVolume())
+    {
+        const G4StepPoint* pPostStepPoint = aStep->GetPostStepPoint();
+        if (pPostStepPoint->GetStepStatus() == fGeomBoundary
+            && pPostStepPoint->GetPhysicalVolume() == myAnalysisManager->GetPhaseSpaceVolume()
+            && myAnalysisManager->AddPhaseSpaceParticle(aStep))
+        {
+            aStep->GetTrack()->SetTrackStatus(fStopAndKill);
+            return;
+        }
+    }
+
     G4int  trackID = aStep->GetTrack()->GetTrackID();
     particle = aStep->GetTrack()->GetDefinition()->GetParticleName();
     G4int particlePDGcode = aStep->GetTrack()->GetDefinition()->GetPDGEncoding();
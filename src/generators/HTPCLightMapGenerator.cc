@@ -0,0 +1,113 @@
+#include "HTPCLightMapGenerator.hh"
+
+#include <G4Event.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4SystemOfUnits.hh>
+
+using namespace std;
+
+HTPCLightMapGenerator::HTPCLightMapGenerator()
+{
+  m_iNbBins[0] = m_iNbBins[1] = m_iNbBins[2] = 10;
+  m_iNextVoxel = 0;
+  m_iCurrentVoxel = -1;
+
+  param->m_pParticleDefinition =
+    G4ParticleTable::GetParticleTable()->FindParticle("opticalphoton");
+  param->m_bIsOpticalphoton = true;
+  param->m_hAngDistType = "iso";
+  param->m_hEnergyDisType = "Mono";
+  param->m_dMonoEnergy = 6.98 * eV;  // 178 nm
+  param->m_iNumberOfParticlesToBeGenerated = 1000;
+}
+
+HTPCLightMapGenerator::~HTPCLightMapGenerator()
+{
+}
+
+void HTPCLightMapGenerator::SetNbBins(G4int iNbBinsX, G4int iNbBinsY, G4int iNbBinsZ)
+{
+  m_iNbBins[0] = iNbBinsX;
+  m_iNbBins[1] = iNbBinsY;
+  m_iNbBins[2] = iNbBinsZ;
+  m_iNextVoxel = 0;
+
+  G4cout << "HTPCLightMapGenerator: " << iNbBinsX << " x " << iNbBinsY << " x "
+         << iNbBinsZ << " voxels" << G4endl;
+}
+
+G4ThreeVector HTPCLightMapGenerator::GetGridMin() const
+{
+  return param->m_hCenterCoords
+         - G4ThreeVector(param->m_dHalfx, param->m_dHalfy, param->m_dHalfz);
+}
+
+G4ThreeVector HTPCLightMapGenerator::GetGridMax() const
+{
+  return param->m_hCenterCoords
+         + G4ThreeVector(param->m_dHalfx, param->m_dHalfy, param->m_dHalfz);
+}
+
+G4ThreeVector HTPCLightMapGenerator::GetVoxelCenter(long iVoxel) const
+{
+  G4ThreeVector hMin = GetGridMin();
+  G4ThreeVector hMax = GetGridMax();
+
+  long iIndex[3];
+  iIndex[0] = iVoxel % m_iNbBins[0];
+  iIndex[1] = (iVoxel / m_iNbBins[0]) % m_iNbBins[1];
+  iIndex[2] = iVoxel / m_iNbBins[0] / m_iNbBins[1];
+
+  G4ThreeVector hCenter;
+  for (G4int i = 0; i < 3; ++i)
+    hCenter[i] = hMin[i] + (iIndex[i] + 0.5) * (hMax[i] - hMin[i]) / m_iNbBins[i];
+
+  return hCenter;
+}
+
+void HTPCLightMapGenerator::GeneratePrimaryVertex(G4Event *pEvent)
+{
+  const long iNbVoxels = (long) m_iNbBins[0] * m_iNbBins[1] * m_iNbBins[2];
+
+  if (param->m_dHalfx <= 0. || param->m_dHalfy <= 0. || param->m_dHalfz <= 0.)
+    G4Exception("HTPCLightMapGenerator::GeneratePrimaryVertex()",
+                "LightMap001", FatalException,
+                "The grid needs /xe/gun/halfx, halfy and halfz.");
+
+  // next voxel whose centre is in the confinement volumes
+  G4int iNbTried = 0;
+  do
+  {
+    if (iNbTried++ == iNbVoxels)
+      G4Exception("HTPCLightMapGenerator::GeneratePrimaryVertex()",
+                  "LightMap002", FatalException,
+                  "No voxel centre inside the confinement volumes.");
+
+    m_iCurrentVoxel = m_iNextVoxel;
+    m_iNextVoxel = (m_iNextVoxel + 1) % iNbVoxels;
+    param->m_hParticlePosition = GetVoxelCenter(m_iCurrentVoxel);
+  }
+  while (param->m_bConfine && !IsSourceConfined());
+
+  G4PrimaryVertex *pVertex =
+    new G4PrimaryVertex(param->m_hParticlePosition, param->m_dParticleTime);
+
+  for (G4int i = 0; i < param->m_iNumberOfParticlesToBeGenerated; i++)
+  {
+    // isotropic direction and random polarisation
+    GenerateThetaFlux();
+
+    G4PrimaryParticle *pPhoton = new G4PrimaryParticle(param->m_pParticleDefinition);
+    pPhoton->SetMomentumDirection(param->m_hParticleMomentumDirection);
+    pPhoton->SetKineticEnergy(param->m_dMonoEnergy);
+    pPhoton->SetPolarization(param->m_hParticlePolarization.x(),
+                             param->m_hParticlePolarization.y(),
+                             param->m_hParticlePolarization.z());
+    pVertex->SetPrimary(pPhoton);
+  }
+
+  param->m_dParticleEnergy = param->m_dMonoEnergy;
+
+  pEvent->AddPrimaryVertex(pVertex);
+}
@@ -0,0 +1,151 @@
+#include "HTPCPhaseSpaceGenerator.hh"
+
+#include <G4Event.hh>
+#include <G4IonTable.hh>
+#include <G4ParticleTable.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4PhysicalConstants.hh>
+#include <G4SystemOfUnits.hh>
+#include <Randomize.hh>
+
+#include <cstring>
+
+using namespace std;
+
+HTPCPhaseSpaceGenerator::HTPCPhaseSpaceGenerator()
+{
+  m_iNbRecords = 0;
+  m_iDataEnd = 0;
+  m_iNbFirstStageEvents = 0;
+  m_dFirstStageWeight = 0.;
+  m_iNbPasses = 0;
+  m_bRotate = false;
+  m_dAngle = 0.;
+}
+
+HTPCPhaseSpaceGenerator::~HTPCPhaseSpaceGenerator()
+{
+}
+
+void HTPCPhaseSpaceGenerator::OpenPhaseSpaceFile()
+{
+  try {
+    m_hBinaryInput.Open(param->m_hInputFileName, HTPCPhaseSpaceWriter::szMagic);
+  } catch (const std::exception &hError) {
+    G4Exception("HTPCPhaseSpaceGenerator::OpenPhaseSpaceFile()", "PhaseSpace001", FatalException, hError.what());
+  }
+
+  // the exposure of the first stage follows the records
+  HTPCPhaseSpaceWriter::Exposure hExposure;
+  const size_t iSize = m_hBinaryInput.GetSize();
+  size_t iRecordBytes = 0;
+  G4bool bExposure = iSize >= HTPCBinaryInput::iMagicSize + sizeof(hExposure);
+  if (bExposure)
+  {
+    iRecordBytes = iSize - HTPCBinaryInput::iMagicSize - sizeof(hExposure);
+    m_hBinaryInput.Seek(iSize - sizeof(hExposure));
+    m_hBinaryInput.Read(&hExposure);
+    bExposure = iRecordBytes % sizeof(HTPCPhaseSpaceWriter::Record) == 0
+                && !memcmp(hExposure.szTag, HTPCPhaseSpaceWriter::szExposureTag, sizeof(hExposure.szTag));
+  }
+  if (!bExposure)
+    G4Exception("HTPCPhaseSpaceGenerator::OpenPhaseSpaceFile()", "PhaseSpace004", FatalException,
+                (param->m_hInputFileName + " has no exposure, the first stage did not finish").c_str());
+  m_iNbFirstStageEvents = hExposure.iNbEvents;
+  m_dFirstStageWeight = hExposure.dWeight;
+  m_hBinaryInput.Rewind();
+
+  m_iNbRecords = iRecordBytes / sizeof(HTPCPhaseSpaceWriter::Record);
+  m_iDataEnd = HTPCBinaryInput::iMagicSize + iRecordBytes;
+  if (m_iNbRecords == 0)
+    G4Exception("HTPCPhaseSpaceGenerator::OpenPhaseSpaceFile()", "PhaseSpace002", FatalException,
+                ("No particles in " + param->m_hInputFileName).c_str());
+
+  G4cout << "Open PHASE SPACE file " << param->m_hInputFileName << " - " << m_iNbRecords
+         << " particles from " << m_iNbFirstStageEvents << " first stage events of total weight "
+         << m_dFirstStageWeight << ". " << G4endl;
+
+  m_iNbPasses = 0;
+  ReadRecord();
+}
+
+G4bool HTPCPhaseSpaceGenerator::ReadRecord()
+{
+  G4bool bRewound = false;
+  if (m_hBinaryInput.GetPosition() >= m_iDataEnd)
+  {
+    m_hBinaryInput.Rewind();
+    ++m_iNbPasses;
+    bRewound = true;
+    G4cout << "EndOfFile ... Pass " << m_iNbPasses + 1 << " over " << param->m_hInputFileName
+           << ", exposure so far " << m_iNbPasses * m_iNbFirstStageEvents << " first stage events of total weight "
+           << m_iNbPasses * m_dFirstStageWeight << G4endl;
+  }
+
+  m_hBinaryInput.Read(&m_hRecord);
+  return bRewound;
+}
+
+void HTPCPhaseSpaceGenerator::GeneratePrimaryVertex(G4Event *pEvent)
+{
+  if (param->first)
+  {
+    param->first = false;
+    OpenPhaseSpaceFile();
+  }
+
+  m_dAngle = m_bRotate ? twopi * G4UniformRand() : 0.;
+
+  // the consecutive records of one first stage event
+  const G4int iEventId = m_hRecord.iEventId;
+  G4long iNbParticles = 0;
+  G4bool bRewound;
+  do
+  {
+    AddVertex(pEvent, m_hRecord);
+    bRewound = ReadRecord();
+  }
+  while (!bRewound && m_hRecord.iEventId == iEventId && ++iNbParticles < m_iNbRecords);
+}
+
+void HTPCPhaseSpaceGenerator::AddVertex(G4Event *pEvent, const HTPCPhaseSpaceWriter::Record &hRecord)
+{
+  G4ParticleDefinition *pDefinition = G4ParticleTable::GetParticleTable()->FindParticle(hRecord.iPDGCode);
+  if (!pDefinition && hRecord.iPDGCode > 1000000000)
+    pDefinition = G4IonTable::GetIonTable()->GetIon(hRecord.iPDGCode);
+  if (!pDefinition)
+  {
+    ostringstream hMessage;
+    hMessage << "Unknown PDG code " << hRecord.iPDGCode << " in " << param->m_hInputFileName;
+    G4Exception("HTPCPhaseSpaceGenerator::AddVertex()", "PhaseSpace003", FatalException, hMessage.str().c_str());
+  }
+
+  G4ThreeVector hPosition(hRecord.fX * mm, hRecord.fY * mm, hRecord.fZ * mm);
+  G4ThreeVector hDirection(hRecord.fCx, hRecord.fCy, hRecord.fCz);
+  G4double dEnergy = hRecord.fEnergy * keV;
+  if (m_dAngle != 0.)
+  {
+    hPosition.rotateZ(m_dAngle);
+    hDirection.rotateZ(m_dAngle);
+  }
+
+  // the first particle is the primary of the event
+  if (!pEvent->GetNumberOfPrimaryVertex())
+  {
+    param->m_pParticleDefinition = pDefinition;
+    param->m_hParticlePosition = hPosition;
+    param->m_hParticleMomentumDirection = hDirection;
+    param->m_dParticleEnergy = dEnergy;
+    param->m_dParticleTime = hRecord.fTime * ns;
+  }
+
+  G4PrimaryParticle *pParticle = new G4PrimaryParticle(pDefinition);
+  pParticle->SetMomentumDirection(hDirection.unit());
+  pParticle->SetKineticEnergy(dEnergy);
+
+  G4PrimaryVertex *pVertex = new G4PrimaryVertex(hPosition, hRecord.fTime * ns);
+  pVertex->SetPrimary(pParticle);
+  pVertex->SetWeight(hRecord.fWeight);
+  pEvent->AddPrimaryVertex(pVertex);
+}
@@ -3,8 +3,75 @@
 #include <G4SystemOfUnits.hh>
 #include <Randomize.hh>
 
+#include <cstdlib>
+#include <cstring>
+
 using namespace std;
 
+namespace {
+
+// line parsing in place on the mapped file, which is not null terminated
+
+const char *NextLine(const char *pLine, const char *pEnd)
+{
+  const char *pNewline = static_cast<const char *>(memchr(pLine, '\n', pEnd - pLine));
+  return pNewline ? pNewline + 1 : pEnd;
+}
+
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\v' || c == '\r';
+}
+
+bool IsBlankLine(const char *pLine, const char *pEnd)
+{
+  for(; pLine < pEnd && *pLine != '\n'; pLine++)
+    if(!IsSpace(*pLine)) return false;
+  return true;
+}
+
+// next whitespace separated token of the line, false at the end of the line
+bool NextToken(const char *&pLine, const char *pEnd, const char *&pToken, size_t &iLength)
+{
+  while(pLine < pEnd && IsSpace(*pLine)) pLine++;
+  if(pLine >= pEnd || *pLine == '\n') return false;
+  pToken = pLine;
+  while(pLine < pEnd && *pLine != '\n' && !IsSpace(*pLine)) pLine++;
+  iLength = pLine - pToken;
+  return true;
+}
+
+// parses up to iMax numbers of the line, returns how many were found
+int ParseNumbers(const char *pLine, const char *pEnd, double *pdValues, int iMax)
+{
+  const char *pToken;
+  size_t iLength;
+  char szToken[64];
+  int iNbValues = 0;
+  while(iNbValues < iMax && NextToken(pLine, pEnd, pToken, iLength))
+  {
+    if(iLength >= sizeof(szToken)) return iNbValues;
+    memcpy(szToken, pToken, iLength);
+    szToken[iLength] = '\0';
+    char *pParsed;
+    pdValues[iNbValues] = strtod(szToken, &pParsed);
+    if(pParsed != szToken + iLength) return iNbValues;
+    iNbValues++;
+  }
+  return iNbValues;
+}
+
+bool FirstTokenIs(const char *pLine, const char *pEnd, const char *szWord)
+{
+  const char *pToken;
+  size_t iLength;
+  return NextToken(pLine, pEnd, pToken, iLength) && iLength == strlen(szWord) &&
+         !memcmp(pToken, szWord, iLength);
+}
+
+}
+
+
 Xenon1tDecay0Generator::Xenon1tDecay0Generator() : Xenon1tGenericGenerator()
 {
   param->first = true;
@@ -15,6 +82,9 @@ Xenon1tDecay0Generator::Xenon1tDecay0Generator() : Xenon1tGenericGenerator()
   m_hParticleCode = new vector<int>;
   m_hParticleTime = new vector<double>;
   m_dTotalEnergyDecay0 = 0.;
+
+  m_iNextEvent = 0;
+  m_iStartEvent = 0;
 }
 
 Xenon1tDecay0Generator::~Xenon1tDecay0Generator()
@@ -134,83 +204,112 @@ G4double Xenon1tDecay0Generator::GetTotalEnergyDecay0()
   return m_dTotalEnergyDecay0;
 }
 
-void Xenon1tDecay0Generator::ReadEventFromDecay0File()
+void Xenon1tDecay0Generator::SetStartEvent(G4long iEvent)
 {
-  // Read raw file and determine data structure
-  char* context = NULL;
-  const char* DELIMITER = " ";
-  char* token[100] = {}; // initialize to 0
-  char* buf = 0;
+  m_iStartEvent = iEvent;
+  if(!m_hEventOffsets.empty())
+    m_iNextEvent = m_iStartEvent % m_hEventOffsets.size();
+}
+
+void Xenon1tDecay0Generator::OpenDecay0File()
+{
+  try {
+    m_hInput.Open(param->m_hInputFileName, 0);
+  } catch (const std::exception &hError) {
+    G4Exception("Xenon1tDecay0Generator::OpenDecay0File()", "Decay0001", FatalException, hError.what());
+  }
 
-  if ((param->first == false) && (!raw.good()))
+  const char *pLine = m_hInput.GetData();
+  const char *pEnd = pLine + m_hInput.GetSize();
+
+  // for each event    - event's number, time of event's start,
+  //                     number of emitted particles;
+  // for each particle - GEANT number of particle,
+  //                     (x,y,z) components of momentum,
+  //                     time shift from previous time
+  // check if "DECAY0" is the first tag
+  while(pLine < pEnd && IsBlankLine(pLine, pEnd))
+    pLine = NextLine(pLine, pEnd);
+  if(!FirstTokenIs(pLine, pEnd, "DECAY0"))
+    G4Exception("Xenon1tDecay0Generator::OpenDecay0File()", "Decay0002", FatalException,
+                ("DECAY0 file " + param->m_hInputFileName + " has unusual structure").c_str());
+
+  // skip header and read "first event" and "last event"
+  while(pLine < pEnd && !FirstTokenIs(pLine, pEnd, "First"))
+    pLine = NextLine(pLine, pEnd);
+  pLine = NextLine(pLine, pEnd);
+  double pdHeader[2] = {0., 0.};
+  ParseNumbers(pLine, pEnd, pdHeader, 2);
+  pLine = NextLine(pLine, pEnd);
+
+  // index of the event starts, the particle lines are skipped unparsed
+  m_hEventOffsets.clear();
+  while(pLine < pEnd)
   {
-    raw.close();
-    if (param->m_iVerbosityLevel >= 1)
+    if(IsBlankLine(pLine, pEnd))
     {
-      G4cout << "EndOfFile - not enough DECAY0 events!" << G4endl;
+      pLine = NextLine(pLine, pEnd);
+      continue;
+    }
+
+    double pdEvent[3];
+    if(ParseNumbers(pLine, pEnd, pdEvent, 3) != 3 || pdEvent[2] < 0.)
+    {
+      G4cout << "Xenon1tDecay0Generator: unreadable event line after event "
+             << m_hEventOffsets.size() << " of " << param->m_hInputFileName << ", ignoring the rest" << G4endl;
+      break;
     }
-    param->first = true;
+    m_hEventOffsets.push_back(pLine - m_hInput.GetData());
+
+    pLine = NextLine(pLine, pEnd);
+    for(long ip = 0; ip < (long) pdEvent[2]; ip++)
+      pLine = NextLine(pLine, pEnd);
+  }
+
+  if(m_hEventOffsets.empty())
+    G4Exception("Xenon1tDecay0Generator::OpenDecay0File()", "Decay0003", FatalException,
+                ("No events in DECAY0 file " + param->m_hInputFileName).c_str());
+
+  m_iNextEvent = m_iStartEvent % m_hEventOffsets.size();
+  if(m_iStartEvent >= (G4long) m_hEventOffsets.size())
+    G4cout << "Xenon1tDecay0Generator: start event " << m_iStartEvent << " beyond the "
+           << m_hEventOffsets.size() << " events of the file, starting at " << m_iNextEvent << G4endl;
+
+  if ((param->m_iVerbosityLevel >= 1) || (stats))
+  {
+    G4cout << "****************** DECAY0 GENERATOR IN ACTION ***************"
+           << G4endl;
+    G4cout << "********************* Open file " << param->m_hInputFileName <<  G4endl;
+    G4cout << "*************************************************************"
+           << G4endl;
+    G4cout << "First event:      " << pdHeader[0] << G4endl;
+    G4cout << "Full # of events: " << pdHeader[1] << G4endl;
+    G4cout << "Events indexed:   " << m_hEventOffsets.size() << G4endl;
+    G4cout << "Start at event:   " << m_iNextEvent << G4endl;
+    G4cout << "*************************************************************"
+           << G4endl;
+    stats = false;
   }
+}
 
+void Xenon1tDecay0Generator::ReadEventFromDecay0File()
+{
   // only the first time open file
   if(param->first)
   {
-    raw.open(param->m_hInputFileName);
-
-    // for each event    - event's number, time of event's start,
-    //                     number of emitted particles;
-    // for each particle - GEANT number of particle,
-    //                     (x,y,z) components of momentum,
-    //                     time shift from previous time
-    // check if "DECAY0" is the first tag
-    while ((getline(raw, linebuffer)) &&
-           (linebuffer[strspn(linebuffer, " \t\v\r\n")] == '\0'))
-    {
-      // Skip blank lines
-    }
-    buf = strdup(linebuffer.c_str());
-    token[0] = strtok_r(buf, DELIMITER, &context); // first token
-    if (strcmp (token[0],"DECAY0") != 0)
-    {
-      G4cout << "Error: DECAY0 file has unusual structure" << G4endl;
-      return;
-    }
-    // skip header and read "first event" and "last event"
-    while (strcmp (token[0],"First") != 0)
-    {
-      getline(raw, linebuffer);
-      if (linebuffer[strspn(linebuffer, " \t\v\r\n")] != '\0')   // not blank
-      {
-        buf = strdup(linebuffer.c_str());
-        token[0] = strtok_r(buf, DELIMITER, &context);
-      }
-    }
-    getline(raw, linebuffer);
-    buf = strdup(linebuffer.c_str());
-    token[0] = strtok_r(buf, DELIMITER, &context);
-    token[1] = strtok_r(0, DELIMITER, &context);
+    OpenDecay0File();
     param->first = false;
+  }
 
-    if ((param->m_iVerbosityLevel >= 1) || (stats))
-    {
-      G4cout << "****************** DECAY0 GENERATOR IN ACTION ***************"
-             << G4endl;
-      G4cout << "********************* Open file " << param->m_hInputFileName <<  G4endl;
-      G4cout << "*************************************************************"
-             << G4endl;
-      G4cout << "First event:      " << token[0] << G4endl;
-      G4cout << "Full # of events: " << token[1] << G4endl;
-      G4cout << "*************************************************************"
-             << G4endl;
-      stats = false;
-    }
-
-    while ((getline(raw, linebuffer)) &&
-           (linebuffer[strspn(linebuffer, " \t\v\r\n")] == '\0'))
+  if(m_iNextEvent >= m_hEventOffsets.size())
+  {
+    if (param->m_iVerbosityLevel >= 1)
     {
-      // Skip blank lines
+      G4cout << "EndOfFile - not enough DECAY0 events!" << G4endl;
     }
+    m_iNextEvent = 0;
   }
+
   if (param->m_iVerbosityLevel >= 1)
   {
     G4cout << "Read Event!" << G4endl;
@@ -222,35 +321,29 @@ void Xenon1tDecay0Generator::ReadEventFromDecay0File()
   m_hParticleTime->clear();
 
   // read event
-  buf = strdup(linebuffer.c_str());
-  token[0] = strtok_r(buf, DELIMITER, &context);
-  token[1] = strtok_r(0, DELIMITER, &context);
-  token[2] = strtok_r(0, DELIMITER, &context);
+  m_hInput.Seek(m_hEventOffsets[m_iNextEvent++]);
+  const char *pLine = m_hInput.GetData() + m_hInput.GetPosition();
+  const char *pEnd = m_hInput.GetData() + m_hInput.GetSize();
+
+  double pdEvent[3];
+  ParseNumbers(pLine, pEnd, pdEvent, 3);
   if (param->m_iVerbosityLevel >= 1)
   {
-    G4cout << "Event #: " << token[0] << G4endl;
+    G4cout << "Event #: " << pdEvent[0] << G4endl;
   }
-  m_hNumberOfProducedParticles->push_back(atoi(token[2]));
+  m_hNumberOfProducedParticles->push_back((int) pdEvent[2]);
 
   for(int ip=0; ip<m_hNumberOfProducedParticles->back(); ip++)
   {
-    getline(raw, linebuffer);
-    buf = strdup(linebuffer.c_str());
-    token[0] = strtok_r(buf, DELIMITER, &context);
-    token[1] = strtok_r(0, DELIMITER, &context);
-    token[2] = strtok_r(0, DELIMITER, &context);
-    token[3] = strtok_r(0, DELIMITER, &context);
-    token[4] = strtok_r(0, DELIMITER, &context);
-    m_hParticleCode->push_back(ConvertGeant3toGeant4ParticleCode(atoi(token[0])));
-    m_hParticleMomentum->push_back(G4ThreeVector(atof(token[1])*MeV,
-                                   atof(token[2])*MeV, atof(token[3])*MeV));
-    m_hParticleTime->push_back(atof(token[4])*s);
-  }
-
-  while ((getline(raw, linebuffer)) &&
-         (linebuffer[strspn(linebuffer, " \t\v\r\n")] == '\0'))
-  {
-    // Skip blank lines
+    pLine = NextLine(pLine, pEnd);
+    double pdParticle[5];
+    if(ParseNumbers(pLine, pEnd, pdParticle, 5) != 5)
+      G4Exception("Xenon1tDecay0Generator::ReadEventFromDecay0File()", "Decay0004", FatalException,
+                  ("Malformed particle line in DECAY0 file " + param->m_hInputFileName).c_str());
+    m_hParticleCode->push_back(ConvertGeant3toGeant4ParticleCode((int) pdParticle[0]));
+    m_hParticleMomentum->push_back(G4ThreeVector(pdParticle[1]*MeV,
+                                   pdParticle[2]*MeV, pdParticle[3]*MeV));
+    m_hParticleTime->push_back(pdParticle[4]*s);
   }
 }
 
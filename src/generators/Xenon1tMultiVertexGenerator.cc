@@ -3,6 +3,8 @@
 #include <G4SystemOfUnits.hh>
 #include <Randomize.hh>
 
+#include <cstdint>
+
 using namespace std;
 
 Xenon1tMultiVertexGenerator::Xenon1tMultiVertexGenerator()
@@ -106,7 +108,17 @@ void Xenon1tMultiVertexGenerator::ReadEventFromMultiFile()
   // only the first time open file
   if (param->first)
   {
-    infile.open(param->m_hInputFileName);
+    if (HTPCBinaryInput::HasMagic(param->m_hInputFileName, "HTPCMV01"))
+    {
+      try {
+        m_hBinaryInput.Open(param->m_hInputFileName, "HTPCMV01");
+      } catch (const std::exception &hError) {
+        G4Exception("Xenon1tMultiVertexGenerator::ReadEventFromMultiFile()", "MultiVertex001",
+                    FatalException, hError.what());
+      }
+    }
+    else
+      infile.open(param->m_hInputFileName);
 
     G4cout << "****************** WAVEFORM GENERATOR IN ACTION *************"
            << G4endl;
@@ -127,6 +139,12 @@ void Xenon1tMultiVertexGenerator::ReadEventFromMultiFile()
   m_hS2timeWidth->clear();
   m_hParticleEnergy->clear();
 
+  if (m_hBinaryInput.IsOpen())
+  {
+    ReadEventFromBinaryFile();
+    return;
+  }
+
   if (!infile.good())
   {
     infile.close();
@@ -145,22 +163,56 @@ void Xenon1tMultiVertexGenerator::ReadEventFromMultiFile()
       infile >> ev[i];
     }
 
-    // position of the spcefici interaction site
-    m_hInteractionVertexPosition->push_back(
-      G4ThreeVector(ev[0] * mm, ev[1] * mm, ev[2] * mm));
-    // time of the spcefici interaction site
-    m_hParticleTime->push_back(ev[3] * ns);
-    // number of particels to generate in that site
-    m_hNumberOfProducedParticles->push_back(ev[4]);
-    // Recoil Type
-    m_hRecoil_type->push_back(ev[5]);
-    // S2 time width (set to 0 for S1)
-    m_hS2timeWidth->push_back(ev[6] * ns);
-    // particle's energy
-    m_hParticleEnergy->push_back(6.98 * eV);
+    AddInteractionSite(ev);
   }
 }
 
+void Xenon1tMultiVertexGenerator::ReadEventFromBinaryFile()
+{
+  // the sites are copied from the mapped file, no parsing
+  try {
+    if (m_hBinaryInput.AtEnd())
+    {
+      m_hBinaryInput.Rewind();
+      G4cout << "EndOfFile ... Start again from the beginning of " << param->m_hInputFileName << G4endl;
+    }
+
+    int32_t iEventId;
+    uint32_t iNbSites;
+    m_hBinaryInput.Read(&iEventId);
+    m_hBinaryInput.Read(&iNbSites);
+    param->EvID = iEventId;
+    m_iNumberOfInteractionSites = iNbSites;
+
+    G4float ev[7];
+    for (uint32_t ip = 0; ip < iNbSites; ip++)
+    {
+      m_hBinaryInput.Read(ev, 7);
+      AddInteractionSite(ev);
+    }
+  } catch (const std::exception &hError) {
+    G4Exception("Xenon1tMultiVertexGenerator::ReadEventFromBinaryFile()", "MultiVertex002",
+                FatalException, hError.what());
+  }
+}
+
+void Xenon1tMultiVertexGenerator::AddInteractionSite(const G4float ev[7])
+{
+  // position of the spcefici interaction site
+  m_hInteractionVertexPosition->push_back(
+    G4ThreeVector(ev[0] * mm, ev[1] * mm, ev[2] * mm));
+  // time of the spcefici interaction site
+  m_hParticleTime->push_back(ev[3] * ns);
+  // number of particels to generate in that site
+  m_hNumberOfProducedParticles->push_back(ev[4]);
+  // Recoil Type
+  m_hRecoil_type->push_back(ev[5]);
+  // S2 time width (set to 0 for S1)
+  m_hS2timeWidth->push_back(ev[6] * ns);
+  // particle's energy
+  m_hParticleEnergy->push_back(6.98 * eV);
+}
+
 G4double Xenon1tMultiVertexGenerator::GetPhotonTime(Int_t Recoil_type)
 {
   G4double aSecondaryTime = 0. * ns;
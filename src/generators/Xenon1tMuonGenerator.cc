@@ -1,12 +1,77 @@
 #include "Xenon1tMuonGenerator.hh"
 
+#include <G4LogicalVolume.hh>
+#include <G4Navigator.hh>
+#include <G4PhysicalConstants.hh>
+#include <G4PhysicalVolumeStore.hh>
 #include <G4SystemOfUnits.hh>
+#include <G4TransportationManager.hh>
+#include <G4VSolid.hh>
 #include <Randomize.hh>
 
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+
 using namespace std;
 
+namespace {
+
+const size_t iMuonRecordSize = 2 * sizeof(int32_t) + 7 * sizeof(float);
+
+// radius of the disk orthogonal to the muon direction where the impact point
+// is uniformly sampled
+const G4double dDiskRadius = 15. * m;
+
+// true if the line through hPos along hDir crosses the vertical cylinder of
+// radius dRadius and half height dHalfZ centred on the origin
+G4bool CrossesCylinder(const G4ThreeVector &hPos, const G4ThreeVector &hDir,
+                       G4double dRadius, G4double dHalfZ)
+{
+  G4double tMin = -DBL_MAX, tMax = DBL_MAX;
+
+  // radial interval
+  G4double a = hDir.x() * hDir.x() + hDir.y() * hDir.y();
+  G4double b = hPos.x() * hDir.x() + hPos.y() * hDir.y();
+  G4double c = hPos.x() * hPos.x() + hPos.y() * hPos.y() - dRadius * dRadius;
+  if (a < 1.e-12)
+  {
+    if (c > 0.)
+      return false;
+  }
+  else
+  {
+    G4double dDiscriminant = b * b - a * c;
+    if (dDiscriminant < 0.)
+      return false;
+    tMin = (-b - sqrt(dDiscriminant)) / a;
+    tMax = (-b + sqrt(dDiscriminant)) / a;
+  }
+
+  // z interval
+  if (fabs(hDir.z()) < 1.e-12)
+    return fabs(hPos.z()) <= dHalfZ;
+  G4double t1 = (-dHalfZ - hPos.z()) / hDir.z();
+  G4double t2 = (dHalfZ - hPos.z()) / hDir.z();
+  if (t1 > t2)
+    std::swap(t1, t2);
+
+  return std::max(tMin, t1) <= std::min(tMax, t2);
+}
+
+}
+
 Xenon1tMuonGenerator::Xenon1tMuonGenerator()
 {
+  m_iNbRecords = 0;
+  m_iStartRecord = -1;
+  m_hSamplingMode = "disk";
+  m_hTargetVolumeName = "phys_oCryostat";
+  m_bGeometryFound = false;
+  m_bTargetCylinder = false;
+  m_dTargetRadius = 0.;
+  m_dTargetHalfZ = 0.;
+  m_dWeight = 1.;
 }
 
 Xenon1tMuonGenerator::~Xenon1tMuonGenerator()
@@ -38,6 +103,7 @@ void Xenon1tMuonGenerator::GeneratePrimaryVertex(G4Event *pEvent)
 
   G4PrimaryVertex * pVertex = new G4PrimaryVertex(param->m_hParticlePosition, param->m_dParticleTime);
   pVertex->SetPrimary(particle);
+  pVertex->SetWeight(m_dWeight);
   pEvent->AddPrimaryVertex(pVertex);
 }
 
@@ -53,23 +119,48 @@ void Xenon1tMuonGenerator::ReadEventFromMuonFile()
   // only the first time open file
   if (param->first)
   {
-    infile.open(param->m_hInputFileName);
     param->first = false;
-
-    G4double rnd = G4UniformRand();
-    G4int iSkip = floor(rnd * 1000000);
-    G4cout << "Open MUON file " << param->m_hInputFileName
-           << " - Skip first " << iSkip << " lines. " << G4endl;
-
-    for (int is = 0; is < iSkip;
-         ++is)    // skip the first iSkip lines of the input file
+    if (HTPCBinaryInput::HasMagic(param->m_hInputFileName, "HTPCMU01"))
     {
-      for (int i = 0; i < 2; i++) infile >> evi[i];
-      for (int i = 0; i < 7; i++) infile >> ev[i];
+      try {
+        m_hBinaryInput.Open(param->m_hInputFileName, "HTPCMU01");
+      } catch (const std::exception &hError) {
+        G4Exception("Xenon1tMuonGenerator::ReadEventFromMuonFile()", "Muon001", FatalException, hError.what());
+      }
+
+      m_iNbRecords = (m_hBinaryInput.GetSize() - HTPCBinaryInput::iMagicSize) / iMuonRecordSize;
+      if (m_iNbRecords == 0)
+        G4Exception("Xenon1tMuonGenerator::ReadEventFromMuonFile()", "Muon002", FatalException,
+                    ("No muons in " + param->m_hInputFileName).c_str());
+
+      // fixed size records, the start is a seek
+      G4long iStart = (m_iStartRecord >= 0) ? m_iStartRecord % m_iNbRecords
+                                            : (G4long) (G4UniformRand() * m_iNbRecords) % m_iNbRecords;
+      m_hBinaryInput.Seek(HTPCBinaryInput::iMagicSize + iStart * iMuonRecordSize);
+      G4cout << "Open MUON file " << param->m_hInputFileName << " - " << m_iNbRecords
+             << " muons, start at " << iStart << ". " << G4endl;
+    }
+    else
+    {
+      infile.open(param->m_hInputFileName);
+
+      G4double rnd = G4UniformRand();
+      G4int iSkip = floor(rnd * 1000000);
+      G4cout << "Open MUON file " << param->m_hInputFileName
+             << " - Skip first " << iSkip << " lines. " << G4endl;
+
+      for (int is = 0; is < iSkip;
+           ++is)    // skip the first iSkip lines of the input file
+      {
+        for (int i = 0; i < 2; i++) infile >> evi[i];
+        for (int i = 0; i < 7; i++) infile >> ev[i];
+      }
     }
   }
 
-  if (infile.good())
+  if (m_hBinaryInput.IsOpen())
+    ReadRecord(evi, ev);
+  else if (infile.good())
   {
     for (int i = 0; i < 2; i++) infile >> evi[i];
     for (int i = 0; i < 7; i++) infile >> ev[i];
@@ -107,11 +198,16 @@ void Xenon1tMuonGenerator::ReadEventFromMuonFile()
   atmp.setMag(1.0);
   btmp.setMag(1.0);
 
-  // Rmax is the radius of the disk orthogonal to the muon direction where the
-  // impact point is uniformly sampled
-  G4double Rmax = 15. * m;
+  if (!m_bGeometryFound)
+    FindWorldAndTarget();
 
-  xyzdisk = FindDiskPos(atmp, btmp, Rmax);
+  if (m_hSamplingMode == "target")
+    xyzdisk = FindTargetDiskPos(cosmu, atmp, btmp);
+  else
+  {
+    xyzdisk = FindDiskPos(atmp, btmp, dDiskRadius);
+    m_dWeight = 1.;
+  }
   initialPos = FindInitPos(cosmu, xyzdisk);
 
   param->m_hParticlePosition = initialPos;
@@ -119,6 +215,93 @@ void Xenon1tMuonGenerator::ReadEventFromMuonFile()
   param->m_dParticleEnergy = ev[0] * GeV;
 }
 
+void Xenon1tMuonGenerator::ReadRecord(G4int evi[2], G4float ev[7])
+{
+  if (m_hBinaryInput.GetSize() - m_hBinaryInput.GetPosition() < iMuonRecordSize)
+  {
+    m_hBinaryInput.Rewind();
+    G4cout << "EndOfFile ... Start again from the beginning of " << param->m_hInputFileName << G4endl;
+  }
+
+  int32_t piRecord[2];
+  m_hBinaryInput.Read(piRecord, 2);
+  m_hBinaryInput.Read(ev, 7);
+  evi[0] = piRecord[0];
+  evi[1] = piRecord[1];
+}
+
+void Xenon1tMuonGenerator::SetTargetCylinder(G4double dRadius, G4double dHalfZ, G4double dCenterZ)
+{
+  m_dTargetRadius = dRadius;
+  m_dTargetHalfZ = dHalfZ;
+  m_hTargetCenter.set(0., 0., dCenterZ);
+  m_bTargetCylinder = true;
+  m_bGeometryFound = false;
+}
+
+void Xenon1tMuonGenerator::FindWorldAndTarget()
+{
+  m_bGeometryFound = true;
+
+  G4VPhysicalVolume *pWorld = G4TransportationManager::GetTransportationManager()
+    ->GetNavigatorForTracking()->GetWorldVolume();
+  pWorld->GetLogicalVolume()->GetSolid()->BoundingLimits(m_hWorldMin, m_hWorldMax);
+
+  if (m_hSamplingMode != "target")
+    return;
+
+  if (!m_bTargetCylinder)
+  {
+    G4VPhysicalVolume *pTarget =
+      G4PhysicalVolumeStore::GetInstance()->GetVolume(m_hTargetVolumeName, false);
+    if (!pTarget)
+      G4Exception("Xenon1tMuonGenerator::FindWorldAndTarget()", "Muon003", FatalException,
+                  ("No volume " + m_hTargetVolumeName + " for the muon target").c_str());
+
+    // the solid is taken as round in xy, like the cryostat, and placed without
+    // rotation in the world
+    if (pTarget->GetMotherLogical() != pWorld->GetLogicalVolume() || pTarget->GetRotation())
+      G4Exception("Xenon1tMuonGenerator::FindWorldAndTarget()", "Muon004", JustWarning,
+                  ("The muon target " + m_hTargetVolumeName +
+                   " is not an unrotated daughter of the world, its placement may be wrong").c_str());
+
+    G4ThreeVector hMin, hMax;
+    pTarget->GetLogicalVolume()->GetSolid()->BoundingLimits(hMin, hMax);
+    m_dTargetRadius = std::max(std::max(-hMin.x(), hMax.x()), std::max(-hMin.y(), hMax.y()));
+    m_dTargetHalfZ = 0.5 * (hMax.z() - hMin.z());
+    m_hTargetCenter.set(0., 0., 0.5 * (hMin.z() + hMax.z()));
+    m_hTargetCenter += pTarget->GetTranslation();
+  }
+
+  if (m_dTargetRadius <= 0. || m_dTargetHalfZ <= 0.)
+    G4Exception("Xenon1tMuonGenerator::FindWorldAndTarget()", "Muon005", FatalException,
+                "The muon target cylinder is empty");
+
+  G4cout << "Muon target: cylinder of radius " << m_dTargetRadius / m << " m and half height "
+         << m_dTargetHalfZ / m << " m centred on " << m_hTargetCenter / m << " m" << G4endl;
+}
+
+// impact point on the disk orthogonal to the muon direction and centred on
+// the target that contains the projection of the target cylinder, sampled
+// until the muon crosses the cylinder
+G4ThreeVector Xenon1tMuonGenerator::FindTargetDiskPos(G4ThreeVector cosd, G4ThreeVector a, G4ThreeVector b)
+{
+  const G4double dProjectedRadius = sqrt(m_dTargetRadius * m_dTargetRadius + m_dTargetHalfZ * m_dTargetHalfZ);
+
+  G4ThreeVector hDiskPos;
+  do
+    hDiskPos = FindDiskPos(a, b, dProjectedRadius);
+  while (!CrossesCylinder(hDiskPos, cosd, m_dTargetRadius, m_dTargetHalfZ));
+
+  // projected area of the cylinder: top face plus side
+  G4double dCos = fabs(cosd.z());
+  G4double dSin = sqrt(std::max(0., 1. - dCos * dCos));
+  G4double dArea = pi * m_dTargetRadius * m_dTargetRadius * dCos + 4. * m_dTargetRadius * m_dTargetHalfZ * dSin;
+  m_dWeight = dArea / (pi * dDiskRadius * dDiskRadius);
+
+  return m_hTargetCenter + hDiskPos;
+}
+
 G4ThreeVector Xenon1tMuonGenerator::FindDiskPos(G4ThreeVector a, G4ThreeVector b, G4double R)
 {
   G4double r = R * sqrt(G4UniformRand());
@@ -139,10 +322,10 @@ G4ThreeVector Xenon1tMuonGenerator::FindInitPos(G4ThreeVector cosd,
 // it works only for down-going muons
 {
   G4float t, xzc, yzc, xyc, zyc, yxc, zxc;
-  //WARNING this MUST match with the WORLD dimensions
-  const G4float Xmin = -20 * m, Xmax = 20 * m, Ymin = -60.5 * m,
-                Ymax = 60.5 * m, Zmin = -20. * m,
-                Zmax = 20. * m;
+  // bounding box of the world volume
+  const G4float Xmin = m_hWorldMin.x(), Xmax = m_hWorldMax.x(), Ymin = m_hWorldMin.y(),
+                Ymax = m_hWorldMax.y(), Zmin = m_hWorldMin.z(),
+                Zmax = m_hWorldMax.z();
 
   G4float x0 = disk[0], y0 = disk[1], z0 = disk[2];
   G4float cx = cosd[0], cy = cosd[1], cz = cosd[2];
@@ -235,12 +418,10 @@ G4ThreeVector Xenon1tMuonGenerator::FindInitPos(G4ThreeVector cosd,
       Vtmp2.set(xyc, Ymin, zyc);
   }
 
-  // choose the first intersection point
+  // choose the first intersection point, a muon missing the world starts
+  // outside of it and is not tracked
   if (iexit == 0)
-  {
-    Vtmp.set(0, 0, 0);
-    return Vtmp;
-  }
+    return disk;
 
   if (iexit == 1)
     return Vtmp;